@@ -178,10 +178,16 @@ function(set_hipace_binary_name)
 
     if(HiPACE_PRECISION STREQUAL "DOUBLE")
         set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".DP")
+    elseif(HiPACE_PRECISION STREQUAL "MIXED")
+        set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".MP")
     else()
         set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".SP")
     endif()
 
+    if(NOT HiPACE_PLASMA_AB_ORDER STREQUAL "5")
+        set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".AB${HiPACE_PLASMA_AB_ORDER}")
+    endif()
+
     #if(HiPACE_ASCENT)
     #    set_property(TARGET HiPACE APPEND_STRING PROPERTY OUTPUT_NAME ".ASCENT")
     #endif()
@@ -40,6 +40,9 @@ macro(find_amrex)
         if(HiPACE_PRECISION STREQUAL "DOUBLE")
             set(AMReX_PRECISION "DOUBLE" CACHE INTERNAL "")
             set(AMReX_PARTICLES_PRECISION "DOUBLE" CACHE INTERNAL "")
+        elseif(HiPACE_PRECISION STREQUAL "MIXED")
+            set(AMReX_PRECISION "SINGLE" CACHE INTERNAL "")
+            set(AMReX_PARTICLES_PRECISION "DOUBLE" CACHE INTERNAL "")
         else()
             set(AMReX_PRECISION "SINGLE" CACHE INTERNAL "")
             set(AMReX_PARTICLES_PRECISION "SINGLE" CACHE INTERNAL "")
@@ -139,7 +142,11 @@ macro(find_amrex)
         message(STATUS "AMReX: Using version '${AMREX_PKG_VERSION}' (${AMREX_GIT_VERSION})") 
     else()
         message(STATUS "Searching for pre-installed AMReX ...")
-        set(COMPONENT_PRECISION ${HiPACE_PRECISION} P${HiPACE_PRECISION})
+        if(HiPACE_PRECISION STREQUAL "MIXED")
+            set(COMPONENT_PRECISION SINGLE PDOUBLE)
+        else()
+            set(COMPONENT_PRECISION ${HiPACE_PRECISION} P${HiPACE_PRECISION})
+        endif()
         find_package(AMReX 21.08 CONFIG REQUIRED COMPONENTS 3D ${COMPONENT_PRECISION} PARTICLES TINYP)
         message(STATUS "AMReX: Found version '${AMReX_VERSION}'")
     endif()
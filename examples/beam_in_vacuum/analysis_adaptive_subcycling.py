@@ -0,0 +1,63 @@
+#! /usr/bin/env python3
+
+# This script compares the width of a beam in a linear external focusing field, pushed with a
+# large time step and either a fixed number of sub-cycles or adaptive sub-cycling, with theory.
+
+import argparse
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+parser = argparse.ArgumentParser(
+    description='Compare fixed and adaptive beam sub-cycling with theory')
+parser.add_argument('--no-subcycling',
+                    dest='no_subcycling',
+                    required=True,
+                    help='Path to the directory containing output files without sub-cycling')
+parser.add_argument('--fixed',
+                    dest='fixed',
+                    required=True,
+                    help='Path to the directory containing output files with fixed sub-cycling')
+parser.add_argument('--adaptive',
+                    dest='adaptive',
+                    required=True,
+                    help='Path to the directory containing output files with adaptive sub-cycling')
+args = parser.parse_args()
+
+# Numerical parameters of the simulation
+field_strength = 0.5
+gamma = 1000.
+x_std_initial = 1./2.
+omega_beta = np.sqrt(field_strength/gamma)
+
+tolerance = 5.e-3
+
+def beam_width(output_dir):
+    ts = OpenPMDTimeSeries(output_dir)
+    xp, yp, wp = ts.get_particle(species='beam', iteration=ts.iterations[-1],
+                                 var_list=['x', 'y', 'w'])
+    std_theory = x_std_initial * np.abs(np.cos(omega_beta * ts.current_t))
+    std_sim_x = np.sqrt(np.sum(xp**2*wp)/np.sum(wp))
+    std_sim_y = np.sqrt(np.sum(yp**2*wp)/np.sum(wp))
+    return std_theory, std_sim_x, std_sim_y
+
+errors = {}
+std_sim = {}
+for name, output_dir in [('no sub-cycling', args.no_subcycling),
+                         ('fixed sub-cycling', args.fixed),
+                         ('adaptive sub-cycling', args.adaptive)]:
+    std_theory, std_sim_x, std_sim_y = beam_width(output_dir)
+    errors[name] = max(np.abs(std_sim_x-std_theory), np.abs(std_sim_y-std_theory))/std_theory
+    std_sim[name] = std_sim_x
+    print(name + ": beam width theory " + str(std_theory) + ", simulation x " + str(std_sim_x)
+          + " y " + str(std_sim_y) + ", relative error " + str(errors[name]))
+
+difference = (np.abs(std_sim['adaptive sub-cycling']-std_sim['fixed sub-cycling'])
+              / std_sim['fixed sub-cycling'])
+print("relative difference between adaptive and fixed sub-cycling: " + str(difference))
+
+# The time step is too large to resolve the betatron oscillation without sub-cycling
+assert(errors['no sub-cycling'] > tolerance)
+# Both sub-cycling methods resolve it, and agree with each other
+assert(errors['fixed sub-cycling'] < tolerance)
+assert(errors['adaptive sub-cycling'] < tolerance)
+assert(difference < tolerance)
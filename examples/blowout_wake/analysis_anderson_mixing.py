@@ -0,0 +1,55 @@
+#! /usr/bin/env python3
+
+# This Python analysis script is part of the code Hipace
+#
+# It compares a simulation where the B-field iterations of the predictor-corrector loop are
+# accelerated with Anderson mixing with a simulation using linear mixing. Both converge to the
+# same B-field error tolerance, so the fields agree up to this tolerance, and Anderson mixing
+# must need fewer iterations on average. The average number of iterations is read from the
+# standard output of the simulations, printed with hipace.verbose = 2.
+
+import argparse
+import re
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+parser = argparse.ArgumentParser(
+    description='Compare Anderson mixing and linear mixing in the predictor-corrector loop')
+parser.add_argument('--linear',
+                    dest='linear',
+                    required=True,
+                    help='Prefix of the output directory and log file with linear mixing')
+parser.add_argument('--anderson',
+                    dest='anderson',
+                    required=True,
+                    help='Prefix of the output directory and log file with Anderson mixing')
+args = parser.parse_args()
+
+def relative_error(a, ref):
+    """Maximum difference between a and ref, relative to the maximum of ref if not zero"""
+    return np.max(np.abs(a - ref)) / max(np.max(np.abs(ref)), np.finfo(ref.dtype).tiny)
+
+def avg_iterations(log_file):
+    """Average number of predictor-corrector iterations, over all time steps of the log"""
+    with open(log_file) as f:
+        values = re.findall(r'avg\. number of iterations ([0-9.eE+-]+)', f.read())
+    assert(len(values) > 0)
+    return np.mean([float(v) for v in values])
+
+iterations_linear = avg_iterations(args.linear + '.txt')
+iterations_anderson = avg_iterations(args.anderson + '.txt')
+print('avg. number of iterations with linear mixing  : ' + str(iterations_linear))
+print('avg. number of iterations with Anderson mixing: ' + str(iterations_anderson))
+assert(iterations_anderson < iterations_linear)
+
+ts_linear = OpenPMDTimeSeries(args.linear)
+ts_anderson = OpenPMDTimeSeries(args.anderson)
+assert(np.all(ts_linear.iterations == ts_anderson.iterations))
+
+for iteration in ts_linear.iterations:
+    for field in ['ExmBy', 'EypBx', 'Ez', 'Bx', 'By', 'Bz', 'jz']:
+        F_linear = ts_linear.get_field(field=field, iteration=iteration)[0]
+        F_anderson = ts_anderson.get_field(field=field, iteration=iteration)[0]
+        error = relative_error(F_anderson, F_linear)
+        print('iteration ' + str(iteration) + ' relative error ' + field + ': ' + str(error))
+        assert(error < 1.e-2)
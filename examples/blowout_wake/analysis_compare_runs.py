@@ -0,0 +1,55 @@
+#! /usr/bin/env python3
+
+# This Python analysis script is part of the code Hipace
+#
+# It compares the fields and the beam of two simulations of the same physical setup run with
+# different numerical options that only change the order of floating-point operations, e.g. the
+# order in which particles are stored or deposited. The results must agree up to the given
+# relative tolerance. The beam particles are compared sorted by id.
+
+import argparse
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+parser = argparse.ArgumentParser(description='Compare the output of two simulations')
+parser.add_argument('--first',
+                    dest='first',
+                    required=True,
+                    help='Path to the directory containing the output files of the reference run')
+parser.add_argument('--second',
+                    dest='second',
+                    required=True,
+                    help='Path to the directory containing the output files of the tested run')
+parser.add_argument('--tolerance',
+                    dest='tolerance',
+                    type=float,
+                    default=1.e-10,
+                    help='Maximum relative error')
+args = parser.parse_args()
+
+def relative_error(a, ref):
+    """Maximum difference between a and ref, relative to the maximum of ref if not zero"""
+    return np.max(np.abs(a - ref)) / max(np.max(np.abs(ref)), np.finfo(ref.dtype).tiny)
+
+ts_first = OpenPMDTimeSeries(args.first)
+ts_second = OpenPMDTimeSeries(args.second)
+assert(np.all(ts_first.iterations == ts_second.iterations))
+
+for iteration in ts_first.iterations:
+    for field in ['ExmBy', 'EypBx', 'Ez', 'Bx', 'By', 'Bz', 'jz']:
+        F_first = ts_first.get_field(field=field, iteration=iteration)[0]
+        F_second = ts_second.get_field(field=field, iteration=iteration)[0]
+        error = relative_error(F_second, F_first)
+        print('iteration ' + str(iteration) + ' relative error ' + field + ': ' + str(error))
+        assert(error < args.tolerance)
+
+    var_list = ['id', 'x', 'y', 'z', 'ux', 'uy', 'uz']
+    p_first = ts_first.get_particle(species='beam', iteration=iteration, var_list=var_list)
+    p_second = ts_second.get_particle(species='beam', iteration=iteration, var_list=var_list)
+    order_first = np.argsort(p_first[0])
+    order_second = np.argsort(p_second[0])
+    assert(np.all(p_first[0][order_first] == p_second[0][order_second]))
+    for name, v_first, v_second in zip(var_list[1:], p_first[1:], p_second[1:]):
+        error = relative_error(v_second[order_second], v_first[order_first])
+        print('iteration ' + str(iteration) + ' relative error beam ' + name + ': ' + str(error))
+        assert(error < args.tolerance)
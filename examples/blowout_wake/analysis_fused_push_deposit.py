@@ -0,0 +1,20 @@
+#! /usr/bin/env python3
+
+# This Python analysis script is part of the code Hipace
+#
+# It compares the fields from a simulation with separate plasma push and deposition kernels and
+# from a simulation with the fused kernel. Both do the same operations in the same order on CPU,
+# so the results must agree up to round-off errors.
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+ts_sep = OpenPMDTimeSeries('push_deposit_separate')
+ts_fus = OpenPMDTimeSeries('push_deposit_fused')
+
+for field in ['ExmBy', 'EypBx', 'Ez', 'Bx', 'By', 'Bz', 'jx', 'jy', 'jz']:
+    F_sep = ts_sep.get_field(field=field, iteration=ts_sep.iterations[-1])[0]
+    F_fus = ts_fus.get_field(field=field, iteration=ts_fus.iterations[-1])[0]
+    error = np.max(np.abs(F_fus - F_sep)) / np.max(np.abs(F_sep))
+    print('relative error ' + field + ': ' + str(error))
+    assert(error < 1.e-10)
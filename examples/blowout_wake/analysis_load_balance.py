@@ -0,0 +1,39 @@
+#! /usr/bin/env python3
+
+# This Python analysis script is part of the code Hipace
+#
+# It compares the fields and the beam from a simulation with load balancing of the boxes in z and
+# from a simulation without. The slices are computed in the same way with any box boundaries, but
+# the beam particles can be stored in a different order, so the results agree up to round-off
+# errors.
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+def relative_error(a, ref):
+    """Maximum difference between a and ref, relative to the maximum of ref if not zero"""
+    return np.max(np.abs(a - ref)) / max(np.max(np.abs(ref)), np.finfo(ref.dtype).tiny)
+
+ts_off = OpenPMDTimeSeries('load_balance_off')
+ts_on = OpenPMDTimeSeries('load_balance_on')
+assert(np.all(ts_off.iterations == ts_on.iterations))
+
+for iteration in ts_off.iterations:
+    for field in ['ExmBy', 'EypBx', 'Ez', 'Bx', 'By', 'Bz', 'jz']:
+        F_off = ts_off.get_field(field=field, iteration=iteration)[0]
+        F_on = ts_on.get_field(field=field, iteration=iteration)[0]
+        error = relative_error(F_on, F_off)
+        print('iteration ' + str(iteration) + ' relative error ' + field + ': ' + str(error))
+        assert(error < 1.e-10)
+
+    # Compare the beam particles, sorted by id
+    var_list = ['id', 'x', 'y', 'z', 'ux', 'uy', 'uz']
+    p_off = ts_off.get_particle(species='beam', iteration=iteration, var_list=var_list)
+    p_on = ts_on.get_particle(species='beam', iteration=iteration, var_list=var_list)
+    order_off = np.argsort(p_off[0])
+    order_on = np.argsort(p_on[0])
+    assert(np.all(p_off[0][order_off] == p_on[0][order_on]))
+    for name, v_off, v_on in zip(var_list[1:], p_off[1:], p_on[1:]):
+        error = relative_error(v_on[order_on], v_off[order_off])
+        print('iteration ' + str(iteration) + ' relative error beam ' + name + ': ' + str(error))
+        assert(error < 1.e-10)
@@ -0,0 +1,20 @@
+#! /usr/bin/env python3
+
+# This Python analysis script is part of the code Hipace
+#
+# It compares the fields from a simulation with the DST Poisson solver and from a simulation with
+# the DST-x / tridiagonal-y Poisson solver. Both solve the same discrete equations, so the results
+# must agree up to round-off errors.
+
+import numpy as np
+from openpmd_viewer import OpenPMDTimeSeries
+
+ts_dst = OpenPMDTimeSeries('poisson_dst')
+ts_tri = OpenPMDTimeSeries('poisson_dst_tridiagonal')
+
+for field in ['ExmBy', 'EypBx', 'Ez', 'Bx', 'By', 'Bz', 'jz']:
+    F_dst = ts_dst.get_field(field=field, iteration=ts_dst.iterations[-1])[0]
+    F_tri = ts_tri.get_field(field=field, iteration=ts_tri.iterations[-1])[0]
+    error = np.max(np.abs(F_tri - F_dst)) / np.max(np.abs(F_dst))
+    print('relative error ' + field + ': ' + str(error))
+    assert(error < 1.e-6)
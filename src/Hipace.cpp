@@ -7,6 +7,7 @@
 
 #include <AMReX_ParmParse.H>
 #include <AMReX_IntVect.H>
+#include <AMReX_Utility.H>
 #ifdef AMREX_USE_LINEAR_SOLVERS
 #  include <AMReX_MLALaplacian.H>
 #  include <AMReX_MLMG.H>
@@ -22,6 +23,92 @@ namespace {
     constexpr int ncomm_z_tag_ghost = 1003;
     constexpr int pcomm_z_tag_ghost = 1004;
     constexpr int tcomm_z_tag = 1005;
+
+    /** \brief Create an MPI datatype describing, at absolute addresses (to use with MPI_BOTTOM),
+     * the AoS and all SoA components of particles [offsets[i], offsets[i]+nps[i]) of each tile.
+     * This sends or receives the particles without packing them.
+     *
+     * \param[in] tiles particle tiles, one per beam
+     * \param[in] offsets index of the first particle to communicate in each tile
+     * \param[in] nps number of particles to communicate in each tile
+     */
+    template <class T_ParTile>
+    MPI_Datatype
+    ParticleRangeType (const amrex::Vector<T_ParTile*>& tiles, const amrex::Vector<int>& offsets,
+                       const amrex::Vector<int>& nps)
+    {
+        amrex::Vector<int> block_lengths;
+        amrex::Vector<MPI_Aint> displacements;
+        auto add_block = [&] (const void* ptr, std::size_t bytes) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+                bytes <= static_cast<std::size_t>(std::numeric_limits<int>::max()),
+                "Too many particles in a box for hipace.pack_free_comms");
+            MPI_Aint address;
+            MPI_Get_address(ptr, &address);
+            block_lengths.push_back(static_cast<int>(bytes));
+            displacements.push_back(address);
+        };
+        for (int i = 0; i < tiles.size(); ++i) {
+            const std::size_t np = nps[i];
+            if (np == 0) continue;
+            auto& ptile = *tiles[i];
+            add_block(ptile.GetArrayOfStructs()().dataPtr() + offsets[i],
+                      np*sizeof(typename T_ParTile::ParticleType));
+            auto& soa = ptile.GetStructOfArrays();
+            for (int comp = 0; comp < ptile.NumRealComps(); ++comp) {
+                add_block(soa.GetRealData(comp).dataPtr() + offsets[i],
+                          np*sizeof(amrex::ParticleReal));
+            }
+            for (int comp = 0; comp < ptile.NumIntComps(); ++comp) {
+                add_block(soa.GetIntData(comp).dataPtr() + offsets[i], np*sizeof(int));
+            }
+        }
+        MPI_Datatype type;
+        MPI_Type_create_hindexed(static_cast<int>(block_lengths.size()), block_lengths.dataPtr(),
+                                 displacements.dataPtr(), MPI_BYTE, &type);
+        MPI_Type_commit(&type);
+        return type;
+    }
+
+    /** \brief Copy particles [src_offset, src_offset+np) of src to [dst_offset, dst_offset+np)
+     * of dst, with one contiguous copy per AoS and SoA component. dst must be large enough. */
+    template <class T_Src, class T_Dst>
+    void
+    CopyParticleRange (const T_Src& src, const int src_offset, T_Dst& dst, const int dst_offset,
+                       const int np)
+    {
+        if (np == 0) return;
+        const auto& src_aos = src.GetArrayOfStructs()();
+        amrex::Gpu::copyAsync(amrex::Gpu::deviceToDevice, src_aos.begin() + src_offset,
+                              src_aos.begin() + src_offset + np,
+                              dst.GetArrayOfStructs()().begin() + dst_offset);
+        for (int comp = 0; comp < src.NumRealComps(); ++comp) {
+            const auto& src_data = src.GetStructOfArrays().GetRealData(comp);
+            amrex::Gpu::copyAsync(amrex::Gpu::deviceToDevice, src_data.begin() + src_offset,
+                                  src_data.begin() + src_offset + np,
+                                  dst.GetStructOfArrays().GetRealData(comp).begin() + dst_offset);
+        }
+        for (int comp = 0; comp < src.NumIntComps(); ++comp) {
+            const auto& src_data = src.GetStructOfArrays().GetIntData(comp);
+            amrex::Gpu::copyAsync(amrex::Gpu::deviceToDevice, src_data.begin() + src_offset,
+                                  src_data.begin() + src_offset + np,
+                                  dst.GetStructOfArrays().GetIntData(comp).begin() + dst_offset);
+        }
+    }
+
+    /** \brief Swap the particle arrays (AoS and all SoA components) of two tiles, without copy */
+    template <class T_A, class T_B>
+    void
+    SwapParticleArrays (T_A& a, T_B& b)
+    {
+        a.GetArrayOfStructs()().swap(b.GetArrayOfStructs()());
+        for (int comp = 0; comp < a.NumRealComps(); ++comp) {
+            a.GetStructOfArrays().GetRealData(comp).swap(b.GetStructOfArrays().GetRealData(comp));
+        }
+        for (int comp = 0; comp < a.NumIntComps(); ++comp) {
+            a.GetStructOfArrays().GetIntData(comp).swap(b.GetStructOfArrays().GetIntData(comp));
+        }
+    }
 }
 #endif
 
@@ -38,6 +125,7 @@ int Hipace::m_depos_order_z = 0;
 amrex::Real Hipace::m_predcorr_B_error_tolerance = 4e-2;
 int Hipace::m_predcorr_max_iterations = 30;
 amrex::Real Hipace::m_predcorr_B_mixing_factor = 0.05;
+int Hipace::m_predcorr_anderson_depth = 0;
 bool Hipace::m_do_beam_jx_jy_deposition = true;
 int Hipace::m_do_device_synchronize = 0;
 int Hipace::m_beam_injection_cr = 1;
@@ -110,6 +198,9 @@ Hipace::Hipace () :
     queryWithParser(pph, "predcorr_B_error_tolerance", m_predcorr_B_error_tolerance);
     queryWithParser(pph, "predcorr_max_iterations", m_predcorr_max_iterations);
     queryWithParser(pph, "predcorr_B_mixing_factor", m_predcorr_B_mixing_factor);
+    queryWithParser(pph, "predcorr_anderson_depth", m_predcorr_anderson_depth);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_predcorr_anderson_depth >= 0,
+                                     "hipace.predcorr_anderson_depth must be >= 0");
     queryWithParser(pph, "output_period", m_output_period);
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_output_period != 0,
                                      "To avoid output, please use output_period = -1.");
@@ -149,8 +240,24 @@ Hipace::Hipace () :
         for (int idim=0; idim<AMREX_SPACEDIM; ++idim) patch_hi[idim] = loc_array[idim];
     }
 
+    queryWithParser(pph, "load_balance_int", m_load_balance_int);
+    queryWithParser(pph, "load_balance_threshold", m_load_balance_threshold);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_load_balance_int <= 0 || maxLevel() == 0,
+        "hipace.load_balance_int is not implemented with mesh refinement");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_load_balance_int <= 0 || m_numprocs_x*m_numprocs_y == 1,
+        "hipace.load_balance_int is not implemented with transverse parallelization");
+
 #ifdef AMREX_USE_MPI
     queryWithParser(pph, "skip_empty_comms", m_skip_empty_comms);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_load_balance_int <= 0 || !m_skip_empty_comms,
+        "hipace.skip_empty_comms cannot be used with hipace.load_balance_int");
+    queryWithParser(pph, "prepost_recv", m_prepost_recv);
+    queryWithParser(pph, "pack_free_comms", m_pack_free_comms);
+#ifdef AMREX_USE_GPU
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!m_pack_free_comms ||
+                                     amrex::ParallelDescriptor::UseGpuAwareMpi(),
+        "hipace.pack_free_comms requires GPU-aware MPI (amrex.use_gpu_aware_mpi = 1)");
+#endif
     int myproc = amrex::ParallelDescriptor::MyProc();
     m_rank_z = myproc/(m_numprocs_x*m_numprocs_y);
     MPI_Comm_split(amrex::ParallelDescriptor::Communicator(), m_rank_z, myproc, &m_comm_xy);
@@ -164,6 +271,10 @@ Hipace::~Hipace ()
 #ifdef AMREX_USE_MPI
     NotifyFinish();
     NotifyFinish(0, true);
+    for (auto* recv : {&m_recv, &m_recv_ghost}) {
+        if (recv->m_buffer) amrex::The_Pinned_Arena()->free(recv->m_buffer);
+        recv->m_buffer = nullptr;
+    }
     MPI_Comm_free(&m_comm_xy);
     MPI_Comm_free(&m_comm_z);
 #endif
@@ -309,7 +420,7 @@ Hipace::MakeNewLevelFromScratch (
     SetDistributionMap(lev, dm); // Let AmrCore know
     DefineSliceGDB(lev, ba, dm);
     m_fields.AllocData(lev, Geom(), m_slice_ba[lev], m_slice_dm[lev],
-                       m_multi_plasma.m_sort_bin_size);
+                       m_multi_plasma.m_sort_bin_size, m_comm_xy);
 }
 
 void
@@ -381,9 +492,10 @@ Hipace::Evolve ()
     HIPACE_PROFILE("Hipace::Evolve()");
     const int rank = amrex::ParallelDescriptor::MyProc();
     int const lev = 0;
-    m_box_sorters.clear();
-    m_multi_beam.sortParticlesByBox(m_box_sorters, boxArray(lev), geom[lev]);
 
+    // number of iterations of the time step loop done by this rank
+    int iteration = 0;
+    m_box_cost.assign((m_boxes_in_z == 1) ? m_numprocs_z : m_boxes_in_z, 0.);
     // now each rank starts with its own time step and writes to its own file. Highest rank starts with step 0
     for (int step = m_numprocs_z - 1 - m_rank_z; step <= m_max_step; step += m_numprocs_z)
     {
@@ -404,12 +516,31 @@ Hipace::Evolve ()
 
         // Loop over longitudinal boxes on this rank, from head to tail
         const int n_boxes = (m_boxes_in_z == 1) ? m_numprocs_z : m_boxes_in_z;
+        // After the boxes are rebalanced, the particles from upstream are still distributed over
+        // the old boxes in this step: they are all received with the first box.
+        const bool drain = step == m_lb_drain_step;
         for (int it = n_boxes-1; it >= 0; --it)
         {
-            Wait(step, it);
-
-            m_box_sorters.clear();
+            if (!drain) {
+                Wait(step, it);
+            } else if (it == n_boxes-1) {
+                for (int jt = it; jt >= 0; --jt) Wait(step, jt);
+            }
+            if (m_prepost_recv) {
+                // Post the receives of the ghost particles of this box and of the next box, so
+                // that they complete while this box is computed
+                if (it>0) {
+                    PostRecv(step, it, true);
+                    if (!drain) PostRecv(step, it-1);
+                } else if (step+m_numprocs_z <= m_max_step) {
+                    PostRecv(step+m_numprocs_z, n_boxes-1);
+                }
+            }
+            // wall time spent computing this box, for the load balancing
+            const amrex::Real box_start_time = amrex::second();
+            amrex::Real box_wait_time = 0.;
 
+            // The box sorters are kept across boxes and steps, so that the sort is incremental
             m_multi_beam.sortParticlesByBox(m_box_sorters, boxArray(lev), geom[lev]);
             m_leftmost_box_snd = std::min(leftmostBoxWithParticles(), m_leftmost_box_snd);
 
@@ -435,9 +566,23 @@ Hipace::Evolve ()
             // Solve central slices
             for (int isl = bx.bigEnd(Direction::z)-1; isl > bx.smallEnd(Direction::z); --isl){
                 SolveOneSlice(isl, it, bins);
+                if (m_prepost_recv) ProgressRecv();
             };
             // Receive ghost slice
-            if (it>0) Wait(step, it, true);
+            if (it>0) {
+                const amrex::Real wait_start_time = amrex::second();
+                amrex::Vector<int> np_before(m_multi_beam.get_nbeams());
+                for (int ibeam = 0; ibeam < m_multi_beam.get_nbeams(); ++ibeam) {
+                    np_before[ibeam] = m_multi_beam.Npart(ibeam);
+                }
+                Wait(step, it, true);
+                // When all particles were received with the first box, the ghost particles are
+                // already copied from the local particles
+                for (int ibeam = 0; ibeam < m_multi_beam.get_nbeams() && drain; ++ibeam) {
+                    m_multi_beam.getBeam(ibeam).resize(np_before[ibeam]);
+                }
+                box_wait_time += amrex::second() - wait_start_time;
+            }
             CheckGhostSlice(it);
             // Solve tail slice. Consume ghost particles.
             SolveOneSlice(bx.smallEnd(Direction::z), it, bins);
@@ -453,6 +598,10 @@ Hipace::Evolve ()
 
             WriteDiagnostics(step, it, OpenPMDWriterCallType::fields);
 
+            if (m_load_balance_int > 0) {
+                m_box_cost[it] += amrex::second() - box_start_time - box_wait_time;
+            }
+
             Notify(step, it, bins[lev]);
         }
 
@@ -464,8 +613,18 @@ Hipace::Evolve ()
         m_predcorr_avg_B_error = 0.;
 
         m_physical_time += m_dt;
+
+        // Rebalance the boxes between two iterations of this loop, if all ranks do the next one
+        ++iteration;
+        if (m_load_balance_int > 0 && iteration % m_load_balance_int == 0 &&
+            m_numprocs_z - 1 + iteration*m_numprocs_z <= m_max_step) {
+            LoadBalanceBoxes(step);
+        }
     }
 
+    if (m_verbose>=1) amrex::AllPrint()<<"Rank "<<rank<<": peak slice workspace "
+                                       << m_fields.getWorkspacePeakBytes() << " bytes\n";
+
 #ifdef HIPACE_USE_OPENPMD
     if (m_output_period > 0) m_openpmd_writer.reset();
 #endif
@@ -504,14 +663,22 @@ Hipace::SolveOneSlice (int islice_coarse, const int ibox,
             if (m_explicit) {
                 // Set all quantities to 0 except Bx and By: the previous slice serves as initial
                 // guess.
-                const int ibx = Comps[WhichSlice::This]["Bx"];
-                const int iby = Comps[WhichSlice::This]["By"];
-                const int nc = Comps[WhichSlice::This]["N"];
-                AMREX_ALWAYS_ASSERT( iby == ibx+1 );
+                // The layout is checked at compile time, see FieldComps.
+                constexpr int ibx = FieldComps::This::Bx;
+                constexpr int iby = FieldComps::This::By;
+                constexpr int nc = FieldComps::This::N;
                 m_fields.getSlices(lev, WhichSlice::This).setVal(
                     0., 0, ibx, m_fields.m_slices_nguards);
                 m_fields.getSlices(lev, WhichSlice::This).setVal(
                     0., iby+1, nc-iby-1, m_fields.m_slices_nguards);
+                // The slices are only shifted after the last sub-slice, so for the other
+                // sub-slices This already contains Bx and By of the previous sub-slice.
+                if (isubslice == nsubslice-1) {
+                    amrex::MultiFab::Copy(
+                        m_fields.getSlices(lev, WhichSlice::This),
+                        m_fields.getSlices(lev, WhichSlice::Previous1),
+                        FieldComps::Previous1::Bx, ibx, 2, m_fields.m_slices_nguards);
+                }
             } else {
                 m_fields.getSlices(lev, WhichSlice::This).setVal(0., m_fields.m_slices_nguards);
             }
@@ -522,7 +689,7 @@ Hipace::SolveOneSlice (int islice_coarse, const int ibox,
             }
 
             amrex::MultiFab rho(m_fields.getSlices(lev, WhichSlice::This), amrex::make_alias,
-                                Comps[WhichSlice::This]["rho"], 1);
+                                FieldComps::This::rho, 1);
 
             if (m_do_tiling) m_multi_plasma.TileSort(bx, geom[lev]);
             m_multi_plasma.DepositCurrent(
@@ -530,7 +697,7 @@ Hipace::SolveOneSlice (int islice_coarse, const int ibox,
 
             if (m_explicit){
                 amrex::MultiFab j_slice_next(m_fields.getSlices(lev, WhichSlice::Next),
-                                             amrex::make_alias, Comps[WhichSlice::Next]["jx"], 4);
+                                             amrex::make_alias, FieldComps::Next::jx, 4);
                 j_slice_next.setVal(0., m_fields.m_slices_nguards);
                 m_multi_beam.DepositCurrentSlice(m_fields, geom, lev, islice_local, bins[lev],
                                                  m_box_sorters, ibox, m_do_beam_jx_jy_deposition,
@@ -543,20 +710,11 @@ Hipace::SolveOneSlice (int islice_coarse, const int ibox,
             m_fields.AddRhoIons(lev);
 
             // need to exchange jx jy jz jx_beam jy_beam jz_beam rho
-            // Assert that the order of the transverse currents and charge density is correct. This
-            // order is also required in the FillBoundary call on the next slice in the
-            // predictor-corrector loop, as well as in the shift slices.
-            const int ijx = Comps[WhichSlice::This]["jx"];
-            const int ijx_beam = Comps[WhichSlice::This]["jx_beam"];
-            const int ijy = Comps[WhichSlice::This]["jy"];
-            const int ijy_beam = Comps[WhichSlice::This]["jy_beam"];
-            const int ijz = Comps[WhichSlice::This]["jz"];
-            const int ijz_beam = Comps[WhichSlice::This]["jz_beam"];
-            const int irho = Comps[WhichSlice::This]["rho"];
-            AMREX_ALWAYS_ASSERT( ijx_beam == ijx+1 && ijy == ijx+2 && ijy_beam == ijx+3 &&
-                                 ijz == ijx+4 && ijz_beam == ijx+5 && irho == ijx+6 );
+            // The order of the transverse currents and charge density is checked at compile time
+            // in FieldComps. This order is also required in the FillBoundary call on the next
+            // slice in the predictor-corrector loop, as well as in the shift slices.
             amrex::MultiFab j_slice(m_fields.getSlices(lev, WhichSlice::This),
-                                    amrex::make_alias, Comps[WhichSlice::This]["jx"], 7);
+                                    amrex::make_alias, FieldComps::This::jx, 7);
             j_slice.FillBoundary(Geom(lev).periodicity());
 
             m_fields.SolvePoissonExmByAndEypBx(Geom(), m_comm_xy, lev, islice);
@@ -569,8 +727,7 @@ Hipace::SolveOneSlice (int islice_coarse, const int ibox,
 
             j_slice.FillBoundary(Geom(lev).periodicity());
 
-            m_fields.SolvePoissonEz(Geom(), lev, islice);
-            m_fields.SolvePoissonBz(Geom(), lev, islice);
+            m_fields.SolvePoissonEzAndBz(Geom(), lev, islice);
 
             // Modifies Bx and By in the current slice and the force terms of the plasma particles
             if (m_explicit){
@@ -627,34 +784,32 @@ Hipace::ExplicitSolveBxBy (const int lev)
     amrex::MultiFab& nslicemf = m_fields.getSlices(lev, nsl);
     const int psl = WhichSlice::Previous1;
     amrex::MultiFab& pslicemf = m_fields.getSlices(lev, psl);
-    const amrex::BoxArray ba = slicemf.boxArray();
-    const amrex::DistributionMapping dm = slicemf.DistributionMap();
     const amrex::IntVect ngv = slicemf.nGrowVect();
 
     // Later this should have only 1 component, but we have 2 for now, with always the same values.
-    amrex::MultiFab Mult(ba, dm, 2, ngv);
-    amrex::MultiFab S(ba, dm, 2, ngv);
+    amrex::MultiFab Mult = m_fields.getWorkspace(lev, 0, 2);
+    amrex::MultiFab S = m_fields.getWorkspace(lev, 2, 2);
     Mult.setVal(0., ngv);
     S.setVal(0., ngv);
 
-    const amrex::MultiFab Rho(slicemf, amrex::make_alias, Comps[isl]["rho"    ], 1);
-    const amrex::MultiFab Jx (slicemf, amrex::make_alias, Comps[isl]["jx"     ], 1);
-    const amrex::MultiFab Jy (slicemf, amrex::make_alias, Comps[isl]["jy"     ], 1);
-    const amrex::MultiFab Jxb(slicemf, amrex::make_alias, Comps[isl]["jx_beam"], 1);
-    const amrex::MultiFab Jyb(slicemf, amrex::make_alias, Comps[isl]["jy_beam"], 1);
-    const amrex::MultiFab Jxx(slicemf, amrex::make_alias, Comps[isl]["jxx"    ], 1);
-    const amrex::MultiFab Jxy(slicemf, amrex::make_alias, Comps[isl]["jxy"    ], 1);
-    const amrex::MultiFab Jyy(slicemf, amrex::make_alias, Comps[isl]["jyy"    ], 1);
-    const amrex::MultiFab Jz (slicemf, amrex::make_alias, Comps[isl]["jz"     ], 1);
-    const amrex::MultiFab Jzb(slicemf, amrex::make_alias, Comps[isl]["jz_beam"], 1);
-    const amrex::MultiFab Psi(slicemf, amrex::make_alias, Comps[isl]["Psi"    ], 1);
-    const amrex::MultiFab Bz (slicemf, amrex::make_alias, Comps[isl]["Bz"     ], 1);
-    const amrex::MultiFab Ez (slicemf, amrex::make_alias, Comps[isl]["Ez"     ], 1);
-    const amrex::MultiFab prev_Jxb(pslicemf, amrex::make_alias, Comps[psl]["jx_beam"], 1);
-    const amrex::MultiFab next_Jxb(nslicemf, amrex::make_alias, Comps[nsl]["jx_beam"], 1);
-    const amrex::MultiFab prev_Jyb(pslicemf, amrex::make_alias, Comps[psl]["jy_beam"], 1);
-    const amrex::MultiFab next_Jyb(nslicemf, amrex::make_alias, Comps[nsl]["jy_beam"], 1);
-    amrex::MultiFab BxBy (slicemf, amrex::make_alias, Comps[isl]["Bx" ], 2);
+    const amrex::MultiFab Rho(slicemf, amrex::make_alias, FieldComps::This::rho, 1);
+    const amrex::MultiFab Jx (slicemf, amrex::make_alias, FieldComps::This::jx, 1);
+    const amrex::MultiFab Jy (slicemf, amrex::make_alias, FieldComps::This::jy, 1);
+    const amrex::MultiFab Jxb(slicemf, amrex::make_alias, FieldComps::This::jx_beam, 1);
+    const amrex::MultiFab Jyb(slicemf, amrex::make_alias, FieldComps::This::jy_beam, 1);
+    const amrex::MultiFab Jxx(slicemf, amrex::make_alias, FieldComps::This::jxx, 1);
+    const amrex::MultiFab Jxy(slicemf, amrex::make_alias, FieldComps::This::jxy, 1);
+    const amrex::MultiFab Jyy(slicemf, amrex::make_alias, FieldComps::This::jyy, 1);
+    const amrex::MultiFab Jz (slicemf, amrex::make_alias, FieldComps::This::jz, 1);
+    const amrex::MultiFab Jzb(slicemf, amrex::make_alias, FieldComps::This::jz_beam, 1);
+    const amrex::MultiFab Psi(slicemf, amrex::make_alias, FieldComps::This::Psi, 1);
+    const amrex::MultiFab Bz (slicemf, amrex::make_alias, FieldComps::This::Bz, 1);
+    const amrex::MultiFab Ez (slicemf, amrex::make_alias, FieldComps::This::Ez, 1);
+    const amrex::MultiFab prev_Jxb(pslicemf, amrex::make_alias, FieldComps::Previous1::jx_beam, 1);
+    const amrex::MultiFab next_Jxb(nslicemf, amrex::make_alias, FieldComps::Next::jx_beam, 1);
+    const amrex::MultiFab prev_Jyb(pslicemf, amrex::make_alias, FieldComps::Previous1::jy_beam, 1);
+    const amrex::MultiFab next_Jyb(nslicemf, amrex::make_alias, FieldComps::Next::jy_beam, 1);
+    amrex::MultiFab BxBy (slicemf, amrex::make_alias, FieldComps::This::Bx, 2);
 
     // preparing conversion to normalized units, if applicable
     PhysConst pc = m_phys_const;
@@ -857,8 +1012,8 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
         m_fields.getSlices(lev, WhichSlice::Previous1),
         m_fields.getSlices(lev, WhichSlice::Previous2),
         m_fields.getSlices(lev, WhichSlice::Previous2),
-        Comps[WhichSlice::Previous1]["Bx"], Comps[WhichSlice::Previous1]["By"],
-        Comps[WhichSlice::Previous2]["Bx"], Comps[WhichSlice::Previous2]["By"],
+        FieldComps::Previous1::Bx, FieldComps::Previous1::By,
+        FieldComps::Previous2::Bx, FieldComps::Previous2::By,
         Geom(lev));
 
     /* Guess Bx and By */
@@ -868,36 +1023,29 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
     m_fields.getSlices(lev, WhichSlice::This).FillBoundary(Geom(lev).periodicity());
     amrex::ParallelContext::pop();
 
-    /* creating temporary Bx and By arrays for the current and previous iteration */
-    amrex::MultiFab Bx_iter(m_fields.getSlices(lev, WhichSlice::This).boxArray(),
-                            m_fields.getSlices(lev, WhichSlice::This).DistributionMap(), 1,
-                            m_fields.getSlices(lev, WhichSlice::This).nGrowVect());
-    amrex::MultiFab By_iter(m_fields.getSlices(lev, WhichSlice::This).boxArray(),
-                            m_fields.getSlices(lev, WhichSlice::This).DistributionMap(), 1,
-                            m_fields.getSlices(lev, WhichSlice::This).nGrowVect());
+    /* temporary Bx and By arrays for the current and previous iteration,
+     * borrowed from the persistent slice workspace */
+    amrex::MultiFab Bx_iter = m_fields.getWorkspace(lev, 0, 1);
+    amrex::MultiFab By_iter = m_fields.getWorkspace(lev, 1, 1);
     Bx_iter.setVal(0.0, m_fields.m_slices_nguards);
     By_iter.setVal(0.0, m_fields.m_slices_nguards);
-    amrex::MultiFab Bx_prev_iter(m_fields.getSlices(lev, WhichSlice::This).boxArray(),
-                                 m_fields.getSlices(lev, WhichSlice::This).DistributionMap(), 1,
-                                 m_fields.getSlices(lev, WhichSlice::This).nGrowVect());
+    amrex::MultiFab Bx_prev_iter = m_fields.getWorkspace(lev, 2, 1);
     amrex::MultiFab::Copy(Bx_prev_iter, m_fields.getSlices(lev, WhichSlice::This),
-                          Comps[WhichSlice::This]["Bx"], 0, 1, m_fields.m_slices_nguards);
-    amrex::MultiFab By_prev_iter(m_fields.getSlices(lev, WhichSlice::This).boxArray(),
-                                 m_fields.getSlices(lev, WhichSlice::This).DistributionMap(), 1,
-                                 m_fields.getSlices(lev, WhichSlice::This).nGrowVect());
+                          FieldComps::This::Bx, 0, 1, m_fields.m_slices_nguards);
+    amrex::MultiFab By_prev_iter = m_fields.getWorkspace(lev, 3, 1);
     amrex::MultiFab::Copy(By_prev_iter, m_fields.getSlices(lev, WhichSlice::This),
-                          Comps[WhichSlice::This]["By"], 0, 1, m_fields.m_slices_nguards);
+                          FieldComps::This::By, 0, 1, m_fields.m_slices_nguards);
 
     /* creating aliases to the current in the next slice.
      * This needs to be reset after each push to the next slice */
     amrex::MultiFab jx_next(m_fields.getSlices(lev, WhichSlice::Next),
-                            amrex::make_alias, Comps[WhichSlice::Next]["jx"], 1);
+                            amrex::make_alias, FieldComps::Next::jx, 1);
     amrex::MultiFab jy_next(m_fields.getSlices(lev, WhichSlice::Next),
-                            amrex::make_alias, Comps[WhichSlice::Next]["jy"], 1);
+                            amrex::make_alias, FieldComps::Next::jy, 1);
     amrex::MultiFab jx_beam_next(m_fields.getSlices(lev, WhichSlice::Next),
-                            amrex::make_alias, Comps[WhichSlice::Next]["jx_beam"], 1);
+                            amrex::make_alias, FieldComps::Next::jx_beam, 1);
     amrex::MultiFab jy_beam_next(m_fields.getSlices(lev, WhichSlice::Next),
-                            amrex::make_alias, Comps[WhichSlice::Next]["jy_beam"], 1);
+                            amrex::make_alias, FieldComps::Next::jy_beam, 1);
 
 
     /* shift force terms, update force terms using guessed Bx and By */
@@ -905,23 +1053,36 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
 
     const int islice = islice_local + boxArray(lev)[ibox].smallEnd(Direction::z);
 
+    /* With the fused kernel, the force update at the end of an iteration is done together
+     * with the push and deposition at the beginning of the next one */
+    const bool fused_push_deposit = m_multi_plasma.m_fused_push_deposit;
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!fused_push_deposit || !m_do_tiling,
+        "plasmas.fused_push_deposit = 1 requires hipace.do_tiling = 0");
+
     /* Begin of predictor corrector loop  */
     int i_iter = 0;
     /* resetting the initial B-field error for mixing between iterations */
     relative_Bfield_error = 1.0;
+    if (m_predcorr_anderson_depth > 0) m_fields.ResetAndersonMixing(lev);
     while (( relative_Bfield_error > m_predcorr_B_error_tolerance )
            && ( i_iter < m_predcorr_max_iterations ))
     {
         i_iter++;
         m_predcorr_avg_iterations += 1.0;
 
-        /* Push particles to the next slice */
-        m_multi_plasma.AdvanceParticles(m_fields, geom[lev], true, true, false, false, lev);
+        if (fused_push_deposit) {
+            /* Update force terms of the previous iteration, push particles to the next slice
+             * and deposit current to next slice */
+            m_multi_plasma.AdvanceAndDepositParticles(m_fields, geom[lev], i_iter > 1, lev);
+        } else {
+            /* Push particles to the next slice */
+            m_multi_plasma.AdvanceParticles(m_fields, geom[lev], true, true, false, false, lev);
 
-        if (m_do_tiling) m_multi_plasma.TileSort(boxArray(lev)[0], geom[lev]);
-        /* deposit current to next slice */
-        m_multi_plasma.DepositCurrent(
-            m_fields, WhichSlice::Next, true, true, false, false, false, geom[lev], lev);
+            if (m_do_tiling) m_multi_plasma.TileSort(boxArray(lev)[0], geom[lev]);
+            /* deposit current to next slice */
+            m_multi_plasma.DepositCurrent(
+                m_fields, WhichSlice::Next, true, true, false, false, false, geom[lev], lev);
+        }
 
         m_multi_beam.DepositCurrentSlice(m_fields, geom, lev, islice_local, bins, m_box_sorters,
                                          ibox, m_do_beam_jx_jy_deposition, WhichSlice::Next);
@@ -930,30 +1091,34 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
         amrex::ParallelContext::push(m_comm_xy);
         // need to exchange jx jy jx_beam jy_beam
         amrex::MultiFab j_slice_next(m_fields.getSlices(lev, WhichSlice::Next),
-                                     amrex::make_alias, Comps[WhichSlice::Next]["jx"], 4);
+                                     amrex::make_alias, FieldComps::Next::jx, 4);
         j_slice_next.FillBoundary(Geom(lev).periodicity());
         amrex::ParallelContext::pop();
 
         /* Calculate Bx and By */
-        m_fields.SolvePoissonBx(Bx_iter, Geom(), lev, islice);
-        m_fields.SolvePoissonBy(By_iter, Geom(), lev, islice);
+        m_fields.SolvePoissonBxAndBy(Bx_iter, By_iter, Geom(), lev, islice);
 
         relative_Bfield_error = m_fields.ComputeRelBFieldError(
             m_fields.getSlices(lev, WhichSlice::This),
             m_fields.getSlices(lev, WhichSlice::This),
             Bx_iter, By_iter,
-            Comps[WhichSlice::This]["Bx"], Comps[WhichSlice::This]["By"],
+            FieldComps::This::Bx, FieldComps::This::By,
             0, 0, Geom(lev));
 
         if (i_iter == 1) relative_Bfield_error_prev_iter = relative_Bfield_error;
 
-        /* Mixing the calculated B fields to the actual B field and shifting iterated B fields */
-        m_fields.MixAndShiftBfields(
-            Bx_iter, Bx_prev_iter, Comps[WhichSlice::This]["Bx"], relative_Bfield_error,
-            relative_Bfield_error_prev_iter, m_predcorr_B_mixing_factor, lev);
-        m_fields.MixAndShiftBfields(
-            By_iter, By_prev_iter, Comps[WhichSlice::This]["By"], relative_Bfield_error,
-            relative_Bfield_error_prev_iter, m_predcorr_B_mixing_factor, lev);
+        if (m_predcorr_anderson_depth > 0) {
+            /* Anderson acceleration using the history of previous iterations */
+            m_fields.AndersonMixBfields(Bx_iter, By_iter, m_predcorr_B_mixing_factor, lev);
+        } else {
+            /* Mixing the calculated B fields to the actual B field and shifting iterated B fields */
+            m_fields.MixAndShiftBfields(
+                Bx_iter, Bx_prev_iter, FieldComps::This::Bx, relative_Bfield_error,
+                relative_Bfield_error_prev_iter, m_predcorr_B_mixing_factor, lev);
+            m_fields.MixAndShiftBfields(
+                By_iter, By_prev_iter, FieldComps::This::By, relative_Bfield_error,
+                relative_Bfield_error_prev_iter, m_predcorr_B_mixing_factor, lev);
+        }
 
         /* resetting current in the next slice to clean temporarily used current*/
         jx_next.setVal(0., m_fields.m_slices_nguards);
@@ -967,12 +1132,19 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
         amrex::ParallelContext::pop();
 
         /* Update force terms using the calculated Bx and By */
-        m_multi_plasma.AdvanceParticles(m_fields, geom[lev], false, false, true, false, lev);
+        if (!fused_push_deposit) {
+            m_multi_plasma.AdvanceParticles(m_fields, geom[lev], false, false, true, false, lev);
+        }
 
         /* Shift relative_Bfield_error values */
         relative_Bfield_error_prev_iter = relative_Bfield_error;
     } /* end of predictor corrector loop */
 
+    /* Update force terms of the last iteration */
+    if (fused_push_deposit && i_iter > 0) {
+        m_multi_plasma.AdvanceParticles(m_fields, geom[lev], false, false, true, false, lev);
+    }
+
     /* resetting the particle position after they have been pushed to the next slice */
     m_multi_plasma.ResetParticles(lev);
 
@@ -995,6 +1167,81 @@ Hipace::PredictorCorrectorLoopToSolveBxBy (const int islice_local, const int lev
                 " n_iter: "<<i_iter<<" relative B field error: "<<relative_Bfield_error<< "\n";
 }
 
+void
+Hipace::LoadBalanceBoxes (const int step)
+{
+    HIPACE_PROFILE("Hipace::LoadBalanceBoxes()");
+    constexpr int lev = 0;
+
+    // Every rank computed every box: sum the costs over all ranks
+    const int n_boxes = m_box_cost.size();
+    amrex::Vector<amrex::Real> cost = m_box_cost;
+    amrex::ParallelAllReduce::Sum(cost.dataPtr(), n_boxes,
+                                  amrex::ParallelDescriptor::Communicator());
+    m_box_cost.assign(n_boxes, 0.);
+
+    const amrex::Real total_cost = std::accumulate(cost.begin(), cost.end(), amrex::Real(0.));
+    const amrex::Real max_cost = *std::max_element(cost.begin(), cost.end());
+    if (total_cost <= 0. || max_cost*n_boxes <= m_load_balance_threshold*total_cost) return;
+
+    // Cost of each cell in z, assuming a uniform cost inside each box. The boxes are ordered
+    // from tail (low z) to head.
+    const amrex::BoxArray& ba = boxArray(lev);
+    const int zlo = Geom(lev).Domain().smallEnd(Direction::z);
+    const int nz = Geom(lev).Domain().length(Direction::z);
+    amrex::Vector<amrex::Real> cell_cost(nz);
+    for (int ibox = 0; ibox < n_boxes; ++ibox) {
+        const amrex::Box& bx = ba[ibox];
+        for (int k = bx.smallEnd(Direction::z); k <= bx.bigEnd(Direction::z); ++k) {
+            cell_cost[k-zlo] = cost[ibox] / bx.length(Direction::z);
+        }
+    }
+
+    // Cut the domain in boxes of equal cost, with at least 3 slices per box (head, central and
+    // tail slices). The box order, hence the head-to-tail order of the pipeline, is unchanged.
+    constexpr int min_length = 3;
+    amrex::Vector<int> box_hi(n_boxes);
+    {
+        int k = 0;
+        amrex::Real cumulative_cost = 0.;
+        for (int ibox = 0; ibox < n_boxes-1; ++ibox) {
+            const amrex::Real target_cost = total_cost*(ibox+1)/n_boxes;
+            const int kmin = (ibox == 0 ? 0 : box_hi[ibox-1]+1) + min_length - 1;
+            const int kmax = nz - 1 - min_length*(n_boxes-1-ibox);
+            while (k < kmax && (k < kmin || cumulative_cost + cell_cost[k] < target_cost)) {
+                cumulative_cost += cell_cost[k];
+                ++k;
+            }
+            box_hi[ibox] = k;
+            cumulative_cost += cell_cost[k];
+            ++k;
+        }
+        box_hi[n_boxes-1] = nz - 1;
+    }
+
+    // New BoxArray, with the same transverse extent
+    amrex::BoxList bl;
+    for (int ibox = 0; ibox < n_boxes; ++ibox) {
+        amrex::Box bx = ba[ibox];
+        bx.setSmall(Direction::z, zlo + (ibox == 0 ? 0 : box_hi[ibox-1]+1));
+        bx.setBig(Direction::z, zlo + box_hi[ibox]);
+        bl.push_back(bx);
+    }
+    SetBoxArray(lev, amrex::BoxArray(std::move(bl)));
+
+    if (m_verbose >= 1) {
+        amrex::Print() << "Load balancing: imbalance " << max_cost*n_boxes/total_cost
+                       << ", new box boundaries in z:";
+        for (int ibox = 0; ibox < n_boxes; ++ibox) {
+            amrex::Print() << " " << boxArray(lev)[ibox].smallEnd(Direction::z);
+        }
+        amrex::Print() << "\n";
+    }
+
+    // The upstream rank of the highest rank does its next step before the rebalancing
+    if (m_rank_z == m_numprocs_z - 1) m_lb_drain_step = step + m_numprocs_z;
+}
+
 void
 Hipace::Wait (const int step, int it, bool only_ghost)
 {
@@ -1003,21 +1250,21 @@ Hipace::Wait (const int step, int it, bool only_ghost)
 #ifdef AMREX_USE_MPI
     if (step == 0) return;
 
+    PipelineRecv& recv = only_ghost ? m_recv_ghost : m_recv;
+    // Without pre-posted receives, post them now
+    if (!recv.m_posted) PostRecv(step, it, only_ghost);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(recv.m_posted && recv.m_step == step && recv.m_it == it,
+        "The pre-posted receive does not match the box being received");
+    recv.m_posted = false;
+
     // Receive physical time
-    if (it == m_numprocs_z - 1 && !only_ghost) {
+    if (recv.m_recv_time) {
         MPI_Status status;
-        // Each rank receives data from upstream, except rank m_numprocs_z-1 who receives from 0
-        MPI_Recv(&m_physical_time, 1,
-                 amrex::ParallelDescriptor::Mpi_typemap<amrex::Real>::type(),
-                 (m_rank_z+1)%m_numprocs_z, tcomm_z_tag, m_comm_z, &status);
+        MPI_Wait(&recv.m_trequest, &status);
+        m_physical_time = recv.m_time;
     }
 
-    const int nbeams = m_multi_beam.get_nbeams();
-    // 1 element per beam species, and 1 for
-    // the index of leftmost box with beam particles.
-    const int nint = nbeams + 1;
-    amrex::Vector<int> np_rcv(nint, 0);
-    if (it < m_leftmost_box_rcv && it < m_numprocs_z - 1 && m_skip_empty_comms){
+    if (recv.m_skipped) {
         if (m_verbose >= 2){
             amrex::AllPrint()<<"rank "<<m_rank_z<<" step "<<step<<" box "<<it<<": SKIP RECV!\n";
         }
@@ -1027,28 +1274,46 @@ Hipace::Wait (const int step, int it, bool only_ghost)
     // Receive particle counts
     {
         MPI_Status status;
-        const int loc_ncomm_z_tag = only_ghost ? ncomm_z_tag_ghost : ncomm_z_tag;
-        // Each rank receives data from upstream, except rank m_numprocs_z-1 who receives from 0
-        MPI_Recv(np_rcv.dataPtr(), nint,
-                 amrex::ParallelDescriptor::Mpi_typemap<int>::type(),
-                 (m_rank_z+1)%m_numprocs_z, loc_ncomm_z_tag, m_comm_z, &status);
+        MPI_Wait(&recv.m_nrequest, &status);
     }
+    const int nbeams = m_multi_beam.get_nbeams();
+    const amrex::Vector<int>& np_rcv = recv.m_np;
     if (!only_ghost) m_leftmost_box_rcv = std::min(np_rcv[nbeams], m_leftmost_box_rcv);
 
     // Receive beam particles.
+    if (!recv.m_particles_posted) PostRecvParticles(recv, only_ghost);
+    if (m_pack_free_comms && !only_ghost) {
+        if (recv.m_buffer_size == 0) return;
+        MPI_Status status;
+        MPI_Wait(&recv.m_prequest, &status);
+
+        // Append the received particles to the beams, in the same order as the packed transfer
+        // so that the results are identical. If the beam tile is empty, e.g. in the first box of
+        // a step, the arrays are swapped instead of copying the received particles.
+        for (int ibeam = 0; ibeam < nbeams; ibeam++){
+            const int np = np_rcv[ibeam];
+            if (np == 0) continue;
+            auto& ptile = m_multi_beam.getBeam(ibeam);
+            auto& rtile = recv.m_tiles[ibeam];
+            const int old_size = ptile.numParticles();
+            if (old_size == 0) {
+                SwapParticleArrays(ptile, rtile);
+                ptile.resize(np);
+            } else {
+                ptile.resize(old_size + np);
+                CopyParticleRange(rtile, 0, ptile, old_size, np);
+            }
+        }
+        amrex::Gpu::streamSynchronize();
+        return;
+    }
     {
-        const amrex::Long np_total = std::accumulate(np_rcv.begin(), np_rcv.begin()+nbeams, 0);
-        if (np_total == 0) return;
+        if (recv.m_buffer_size == 0) return;
         const amrex::Long psize = sizeof(BeamParticleContainer::SuperParticleType);
-        const amrex::Long buffer_size = psize*np_total;
-        auto recv_buffer = (char*)amrex::The_Pinned_Arena()->alloc(buffer_size);
+        char* const recv_buffer = recv.m_buffer;
 
         MPI_Status status;
-        const int loc_pcomm_z_tag = only_ghost ? pcomm_z_tag_ghost : pcomm_z_tag;
-        // Each rank receives data from upstream, except rank m_numprocs_z-1 who receives from 0
-        MPI_Recv(recv_buffer, buffer_size,
-                 amrex::ParallelDescriptor::Mpi_typemap<char>::type(),
-                 (m_rank_z+1)%m_numprocs_z, loc_pcomm_z_tag, m_comm_z, &status);
+        MPI_Wait(&recv.m_prequest, &status);
 
         int offset_beam = 0;
         for (int ibeam = 0; ibeam < nbeams; ibeam++){
@@ -1059,10 +1324,10 @@ Hipace::Wait (const int step, int it, bool only_ghost)
             ptile.resize(new_size);
             const auto ptd = ptile.getParticleTileData();
 
-            const amrex::Gpu::DeviceVector<int> comm_real(m_multi_beam.NumRealComps(), 1);
-            const amrex::Gpu::DeviceVector<int> comm_int (m_multi_beam.NumIntComps(),  1);
-            const auto p_comm_real = comm_real.data();
-            const auto p_comm_int = comm_int.data();
+            // all components are communicated
+            const auto p_comm_real = m_fields.getCommFlagsWorkspace(
+                std::max(m_multi_beam.NumRealComps(), m_multi_beam.NumIntComps()));
+            const auto p_comm_int = p_comm_real;
 
 #ifdef AMREX_USE_GPU
             if (amrex::Gpu::inLaunchRegion() && np > 0) {
@@ -1109,13 +1374,114 @@ Hipace::Wait (const int step, int it, bool only_ghost)
             offset_beam += np;
         }
 
+        // the buffer is kept for the next receive
         amrex::Gpu::Device::synchronize();
-        amrex::The_Pinned_Arena()->free(recv_buffer);
     }
 
 #endif
 }
 
+void
+Hipace::PostRecv (const int step, const int it, bool only_ghost)
+{
+#ifdef AMREX_USE_MPI
+    if (step == 0) return;
+
+    PipelineRecv& recv = only_ghost ? m_recv_ghost : m_recv;
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!recv.m_posted,
+        "Cannot post a receive before the previous one is completed");
+    recv.m_posted = true;
+    recv.m_step = step;
+    recv.m_it = it;
+    recv.m_particles_posted = false;
+    recv.m_buffer_size = 0;
+
+    // Each rank receives data from upstream, except rank m_numprocs_z-1 who receives from 0
+    const int upstream = (m_rank_z+1)%m_numprocs_z;
+
+    // Receive physical time
+    recv.m_recv_time = it == m_numprocs_z - 1 && !only_ghost;
+    if (recv.m_recv_time) {
+        MPI_Irecv(&recv.m_time, 1, amrex::ParallelDescriptor::Mpi_typemap<amrex::Real>::type(),
+                  upstream, tcomm_z_tag, m_comm_z, &recv.m_trequest);
+    }
+
+    // m_leftmost_box_rcv is up to date, as the receives are completed in order
+    recv.m_skipped = it < m_leftmost_box_rcv && it < m_numprocs_z - 1 && m_skip_empty_comms;
+    if (recv.m_skipped) return;
+
+    // Receive particle counts: 1 element per beam species, and 1 for
+    // the index of leftmost box with beam particles.
+    const int nint = m_multi_beam.get_nbeams() + 1;
+    recv.m_np.assign(nint, 0);
+    const int loc_ncomm_z_tag = only_ghost ? ncomm_z_tag_ghost : ncomm_z_tag;
+    MPI_Irecv(recv.m_np.dataPtr(), nint, amrex::ParallelDescriptor::Mpi_typemap<int>::type(),
+              upstream, loc_ncomm_z_tag, m_comm_z, &recv.m_nrequest);
+#else
+    amrex::ignore_unused(step, it, only_ghost);
+#endif
+}
+
+void
+Hipace::ProgressRecv ()
+{
+#ifdef AMREX_USE_MPI
+    for (bool only_ghost : {false, true}) {
+        PipelineRecv& recv = only_ghost ? m_recv_ghost : m_recv;
+        if (!recv.m_posted || recv.m_skipped || recv.m_particles_posted) continue;
+        int flag = 0;
+        MPI_Status status;
+        MPI_Test(&recv.m_nrequest, &flag, &status);
+        if (flag) PostRecvParticles(recv, only_ghost);
+    }
+#endif
+}
+
+void
+Hipace::PostRecvParticles (PipelineRecv& recv, bool only_ghost)
+{
+#ifdef AMREX_USE_MPI
+    const int nbeams = m_multi_beam.get_nbeams();
+    const amrex::Long np_total = std::accumulate(recv.m_np.begin(), recv.m_np.begin()+nbeams, 0);
+    const amrex::Long psize = sizeof(BeamParticleContainer::SuperParticleType);
+    recv.m_particles_posted = true;
+    recv.m_buffer_size = psize*np_total;
+    if (np_total == 0) return;
+
+    if (m_pack_free_comms && !only_ghost) {
+        // Receive without packing in per-beam tiles, kept across receives. The beam tiles
+        // cannot grow while the current box is computed, the particles are moved in Wait.
+        recv.m_tiles.resize(nbeams);
+        amrex::Vector<amrex::ParticleTile<0, 0, BeamIdx::nattribs, 0>*> tiles(nbeams);
+        for (int ibeam = 0; ibeam < nbeams; ibeam++){
+            recv.m_tiles[ibeam].resize(recv.m_np[ibeam]);
+            tiles[ibeam] = &recv.m_tiles[ibeam];
+        }
+        const amrex::Vector<int> offsets(nbeams, 0);
+        const amrex::Vector<int> nps(recv.m_np.begin(), recv.m_np.begin()+nbeams);
+        MPI_Datatype type = ParticleRangeType(tiles, offsets, nps);
+        MPI_Irecv(MPI_BOTTOM, 1, type, (m_rank_z+1)%m_numprocs_z, pcomm_z_tag, m_comm_z,
+                  &recv.m_prequest);
+        MPI_Type_free(&type);
+        return;
+    }
+
+    if (recv.m_capacity < recv.m_buffer_size) {
+        if (recv.m_buffer) amrex::The_Pinned_Arena()->free(recv.m_buffer);
+        recv.m_buffer = (char*)amrex::The_Pinned_Arena()->alloc(recv.m_buffer_size);
+        recv.m_capacity = recv.m_buffer_size;
+    }
+
+    const int loc_pcomm_z_tag = only_ghost ? pcomm_z_tag_ghost : pcomm_z_tag;
+    // Each rank receives data from upstream, except rank m_numprocs_z-1 who receives from 0
+    MPI_Irecv(recv.m_buffer, recv.m_buffer_size,
+              amrex::ParallelDescriptor::Mpi_typemap<char>::type(),
+              (m_rank_z+1)%m_numprocs_z, loc_pcomm_z_tag, m_comm_z, &recv.m_prequest);
+#else
+    amrex::ignore_unused(recv, only_ghost);
+#endif
+}
+
 void
 Hipace::Notify (const int step, const int it,
                 amrex::Vector<BeamBins>& bins, bool only_ghost)
@@ -1177,6 +1543,46 @@ Hipace::Notify (const int step, const int it,
     MPI_Isend(np_snd.dataPtr(), nint, amrex::ParallelDescriptor::Mpi_typemap<int>::type(),
               (m_rank_z-1+m_numprocs_z)%m_numprocs_z, loc_ncomm_z_tag, m_comm_z, loc_nsend_request);
 
+    // Send beam particles of the box, which are contiguous after the box sort, without packing.
+    // MPI reads them until the send completes in NotifyFinish, so they are moved to a send tile:
+    // the particles of the box are at the end of the beam tile, after the particles of the
+    // downstream boxes, which are usually few. The arrays are swapped and these particles are
+    // copied back, unless the box has fewer particles.
+    if (m_pack_free_comms && !only_ghost) {
+        const amrex::Long np_total = std::accumulate(np_snd.begin(), np_snd.begin()+nbeams, 0);
+        if (np_total == 0) return;
+        m_send_tiles.resize(nbeams);
+        amrex::Vector<amrex::ParticleTile<0, 0, BeamIdx::nattribs, 0>*> tiles(nbeams);
+        amrex::Vector<int> offsets(nbeams);
+        for (int ibeam = 0; ibeam < nbeams; ibeam++){
+            auto& ptile = m_multi_beam.getBeam(ibeam);
+            auto& stile = m_send_tiles[ibeam];
+            const int offset_box = m_box_sorters[ibeam].boxOffsetsPtr()[it];
+            const int np = np_snd[ibeam];
+            tiles[ibeam] = &stile;
+            if (offset_box <= np) {
+                SwapParticleArrays(ptile, stile);
+                ptile.resize(offset_box);
+                CopyParticleRange(stile, 0, ptile, 0, offset_box);
+                offsets[ibeam] = offset_box;
+            } else {
+                stile.resize(np);
+                CopyParticleRange(ptile, offset_box, stile, 0, np);
+                // Delete beam particles that we just sent from the particle array
+                ptile.resize(offset_box);
+                offsets[ibeam] = 0;
+            }
+        }
+        amrex::Gpu::streamSynchronize();
+        const amrex::Vector<int> nps(np_snd.begin(), np_snd.begin()+nbeams);
+        MPI_Datatype type = ParticleRangeType(tiles, offsets, nps);
+        // Each rank sends data downstream, except rank 0 who sends data to m_numprocs_z-1
+        MPI_Isend(MPI_BOTTOM, 1, type, (m_rank_z-1+m_numprocs_z)%m_numprocs_z, pcomm_z_tag,
+                  m_comm_z, &m_psend_request);
+        MPI_Type_free(&type);
+        return;
+    }
+
     // Send beam particles. Currently only one tile.
     {
         const amrex::Long np_total = std::accumulate(np_snd.begin(), np_snd.begin()+nbeams, 0);
@@ -1194,10 +1600,10 @@ Hipace::Notify (const int step, const int it,
             auto& ptile = m_multi_beam.getBeam(ibeam);
             const auto ptd = ptile.getConstParticleTileData();
 
-            const amrex::Gpu::DeviceVector<int> comm_real(m_multi_beam.NumRealComps(), 1);
-            const amrex::Gpu::DeviceVector<int> comm_int (m_multi_beam.NumIntComps(),  1);
-            const auto p_comm_real = comm_real.data();
-            const auto p_comm_int = comm_int.data();
+            // all components are communicated
+            const auto p_comm_real = m_fields.getCommFlagsWorkspace(
+                std::max(m_multi_beam.NumRealComps(), m_multi_beam.NumIntComps()));
+            const auto p_comm_int = p_comm_real;
             const auto p_psend_buffer = psend_buffer + offset_beam*psize;
 
             BeamBins::index_type* indices = nullptr;
@@ -1210,6 +1616,8 @@ Hipace::Notify (const int step, const int it,
             // The particles that are in the last slice (sent as ghost particles) are
             // given by the indices[cell_start:cell_stop-1]
             cell_start = offsets[bx.bigEnd(Direction::z)-bx.smallEnd(Direction::z)];
+            // bins are on level 0, where the particles of a slice can be contiguous
+            const bool slice_contiguous = ptile.m_slice_contiguous;
 
 #ifdef AMREX_USE_GPU
             if (amrex::Gpu::inLaunchRegion() && np > 0) {
@@ -1229,7 +1637,8 @@ Hipace::Notify (const int step, const int it,
                         const unsigned int m = threadIdx.x;
                         const unsigned int mend = amrex::min<unsigned int>(blockDim.x, np-blockDim.x*blockIdx.x);
                         if (i < np) {
-                            const int src_i = only_ghost ? indices[cell_start+i] : i;
+                            const int src_i = !only_ghost ? i :
+                        (slice_contiguous ? cell_start+i : indices[cell_start+i]);
                             ptd.packParticleData(shared, offset_box+src_i, m*psize, p_comm_real, p_comm_int);
                         }
 
@@ -1248,7 +1657,8 @@ Hipace::Notify (const int step, const int it,
             {
                 for (int i = 0; i < np; ++i)
                 {
-                    const int src_i = only_ghost ? indices[cell_start+i] : i;
+                    const int src_i = !only_ghost ? i :
+                        (slice_contiguous ? cell_start+i : indices[cell_start+i]);
                     ptd.packParticleData(p_psend_buffer, offset_box+src_i, i*psize, p_comm_real, p_comm_int);
                 }
             }
@@ -1304,6 +1714,10 @@ Hipace::NotifyFinish (const int it, bool only_ghost)
             MPI_Wait(&m_psend_request, &status);
             amrex::The_Pinned_Arena()->free(m_psend_buffer);
             m_psend_buffer = nullptr;
+        } else if (m_psend_request != MPI_REQUEST_NULL) {
+            // particles sent without packing from m_send_tiles
+            MPI_Status status;
+            MPI_Wait(&m_psend_request, &status);
         }
     }
 #endif
@@ -0,0 +1,134 @@
+#include "AndersonMixing.H"
+#include "utils/HipaceProfilerWrapper.H"
+
+#include <AMReX_ParallelReduce.H>
+
+#include <algorithm>
+#include <cmath>
+
+void
+AndersonMixing::define (const amrex::BoxArray& ba, const amrex::DistributionMapping& dm,
+                        const amrex::IntVect& ngrow, const int ncomp, const int depth,
+                        const MPI_Comm& comm_xy)
+{
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp > 0 && depth > 0,
+                                     "Anderson mixing needs at least one field and depth >= 1");
+    m_ncomp = ncomp;
+    m_depth = depth;
+    m_comm_xy = comm_xy;
+
+    const amrex::MFInfo info = amrex::MFInfo().SetArena(amrex::The_Arena());
+    m_f.define(ba, dm, ncomp, ngrow, info);
+    m_x_prev.define(ba, dm, ncomp, ngrow, info);
+    m_f_prev.define(ba, dm, ncomp, ngrow, info);
+    m_dx.define(ba, dm, depth*ncomp, ngrow, info);
+    m_df.define(ba, dm, depth*ncomp, ngrow, info);
+    reset();
+}
+
+void
+AndersonMixing::Mix (amrex::Vector<amrex::MultiFab*> const& x,
+                     amrex::Vector<amrex::MultiFab const*> const& g, const amrex::Real beta)
+{
+    HIPACE_PROFILE("AndersonMixing::Mix()");
+    using namespace amrex::literals;
+
+    AMREX_ALWAYS_ASSERT(static_cast<int>(x.size()) == m_ncomp &&
+                        static_cast<int>(g.size()) == m_ncomp);
+    const amrex::IntVect ng = m_f.nGrowVect();
+
+    // residual f_k = g_k - x_k
+    for (int n = 0; n < m_ncomp; ++n) {
+        amrex::MultiFab::LinComb(m_f, 1._rt, *g[n], 0, -1._rt, *x[n], 0, n, 1, ng);
+    }
+
+    // store the differences to the previous iteration in the history ring
+    if (m_has_prev) {
+        const int slot = m_head*m_ncomp;
+        for (int n = 0; n < m_ncomp; ++n) {
+            amrex::MultiFab::LinComb(m_dx, 1._rt, *x[n], 0, -1._rt, m_x_prev, n, slot+n, 1, ng);
+        }
+        amrex::MultiFab::LinComb(m_df, 1._rt, m_f, 0, -1._rt, m_f_prev, 0, slot, m_ncomp, ng);
+        m_head = (m_head + 1) % m_depth;
+        m_nhist = std::min(m_nhist + 1, m_depth);
+    }
+    for (int n = 0; n < m_ncomp; ++n) {
+        amrex::MultiFab::Copy(m_x_prev, *x[n], 0, n, 1, ng);
+    }
+    amrex::MultiFab::Copy(m_f_prev, m_f, 0, 0, m_ncomp, ng);
+    m_has_prev = true;
+
+    // gamma minimizes |f_k - sum_i gamma_i df_i|. The order of the slots in the ring does not
+    // matter. All dot products are reduced over the transverse communicator at once.
+    const int nh = m_nhist;
+    amrex::Vector<amrex::Real> gamma(nh, 0._rt);
+    if (nh > 0) {
+        amrex::Vector<amrex::Real> dots(nh*nh + nh, 0._rt);
+        for (int i = 0; i < nh; ++i) {
+            for (int j = i; j < nh; ++j) {
+                dots[i*nh+j] = amrex::MultiFab::Dot(m_df, i*m_ncomp, m_df, j*m_ncomp, m_ncomp,
+                                                    0, true);
+            }
+            dots[nh*nh+i] = amrex::MultiFab::Dot(m_df, i*m_ncomp, m_f, 0, m_ncomp, 0, true);
+        }
+        amrex::ParallelAllReduce::Sum(dots.data(), static_cast<int>(dots.size()), m_comm_xy);
+
+        amrex::Vector<amrex::Real> mat(nh*nh);
+        for (int i = 0; i < nh; ++i) {
+            for (int j = 0; j < nh; ++j) {
+                mat[i*nh+j] = (j >= i) ? dots[i*nh+j] : dots[j*nh+i];
+            }
+            gamma[i] = dots[nh*nh+i];
+        }
+        // fall back to linear mixing if the history is degenerate
+        if (!SolveNormalEquations(mat, gamma, nh)) {
+            gamma.assign(nh, 0._rt);
+        }
+    }
+
+    // x_{k+1} = x_k + beta f_k - sum_i gamma_i (dx_i + beta df_i)
+    for (int n = 0; n < m_ncomp; ++n) {
+        amrex::MultiFab::Saxpy(*x[n], beta, m_f, n, 0, 1, ng);
+        for (int i = 0; i < nh; ++i) {
+            if (gamma[i] == 0._rt) continue;
+            amrex::MultiFab::Saxpy(*x[n], -gamma[i], m_dx, i*m_ncomp+n, 0, 1, ng);
+            amrex::MultiFab::Saxpy(*x[n], -gamma[i]*beta, m_df, i*m_ncomp+n, 0, 1, ng);
+        }
+    }
+}
+
+bool
+AndersonMixing::SolveNormalEquations (amrex::Vector<amrex::Real>& mat,
+                                      amrex::Vector<amrex::Real>& rhs, const int n)
+{
+    using namespace amrex::literals;
+
+    // Small Tikhonov regularization, as consecutive residuals are often nearly collinear
+    amrex::Real trace = 0._rt;
+    for (int i = 0; i < n; ++i) trace += mat[i*n+i];
+    if (!(trace > 0._rt)) return false;
+    for (int i = 0; i < n; ++i) mat[i*n+i] += 1.e-10_rt * trace / n;
+
+    // Gaussian elimination with partial pivoting, n is at most the Anderson depth
+    for (int k = 0; k < n; ++k) {
+        int piv = k;
+        for (int i = k+1; i < n; ++i) {
+            if (std::abs(mat[i*n+k]) > std::abs(mat[piv*n+k])) piv = i;
+        }
+        if (std::abs(mat[piv*n+k]) <= 1.e-30_rt * trace) return false;
+        if (piv != k) {
+            for (int j = 0; j < n; ++j) std::swap(mat[k*n+j], mat[piv*n+j]);
+            std::swap(rhs[k], rhs[piv]);
+        }
+        for (int i = k+1; i < n; ++i) {
+            const amrex::Real factor = mat[i*n+k] / mat[k*n+k];
+            for (int j = k; j < n; ++j) mat[i*n+j] -= factor * mat[k*n+j];
+            rhs[i] -= factor * rhs[k];
+        }
+    }
+    for (int k = n-1; k >= 0; --k) {
+        for (int j = k+1; j < n; ++j) rhs[k] -= mat[k*n+j] * rhs[j];
+        rhs[k] /= mat[k*n+k];
+    }
+    return true;
+}
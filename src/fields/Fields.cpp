@@ -1,6 +1,7 @@
 #include "Fields.H"
 #include "fft_poisson_solver/FFTPoissonSolverPeriodic.H"
 #include "fft_poisson_solver/FFTPoissonSolverDirichlet.H"
+#include "fft_poisson_solver/FFTPoissonSolverDirichletTridiagonal.H"
 #include "Hipace.H"
 #include "utils/HipaceProfilerWrapper.H"
 #include "utils/Constants.H"
@@ -12,16 +13,26 @@ amrex::IntVect Fields::m_slices_nguards = {-1, -1, -1};
 amrex::IntVect Fields::m_poisson_nguards = {-1, -1, -1};
 
 Fields::Fields (Hipace const* a_hipace)
-    : m_slices(a_hipace->maxLevel()+1)
+    : m_slices(a_hipace->maxLevel()+1),
+      m_slice_storage(a_hipace->maxLevel()+1),
+      m_workspace(a_hipace->maxLevel()+1),
+      m_anderson(a_hipace->maxLevel()+1)
 {
     amrex::ParmParse ppf("fields");
     queryWithParser(ppf, "do_dirichlet_poisson", m_do_dirichlet_poisson);
+    std::string dirichlet_solver = "dst";
+    queryWithParser(ppf, "dirichlet_poisson_solver", dirichlet_solver);
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+        dirichlet_solver == "dst" ||
+        dirichlet_solver == "dst_tridiagonal",
+        "fields.dirichlet_poisson_solver must be dst or dst_tridiagonal");
+    if (dirichlet_solver == "dst_tridiagonal") m_use_tridiagonal_poisson = true;
 }
 
 void
 Fields::AllocData (
     int lev, amrex::Vector<amrex::Geometry> const& geom, const amrex::BoxArray& slice_ba,
-    const amrex::DistributionMapping& slice_dm, int bin_size)
+    const amrex::DistributionMapping& slice_dm, int bin_size, const MPI_Comm& comm_xy)
 {
     HIPACE_PROFILE("Fields::AllocData()");
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(slice_ba.size() == 1,
@@ -34,16 +45,33 @@ Fields::AllocData (
     m_poisson_nguards = {0, 0, 0};
 
     for (int islice=0; islice<WhichSlice::N; islice++) {
+        m_slice_storage[lev][islice] = islice;
         m_slices[lev][islice].define(
-            slice_ba, slice_dm, Comps[islice]["N"], m_slices_nguards,
+            slice_ba, slice_dm, NCompsPerSlice[islice], m_slices_nguards,
             amrex::MFInfo().SetArena(amrex::The_Arena()));
         m_slices[lev][islice].setVal(0._rt, m_slices_nguards);
     }
 
+    m_workspace[lev].define(slice_ba, slice_dm, m_workspace_ncomp, m_slices_nguards,
+                            amrex::MFInfo().SetArena(amrex::The_Arena()));
+    UpdateWorkspaceBytes();
+
+    if (Hipace::m_predcorr_anderson_depth > 0) {
+        // history of Bx and By for the predictor-corrector loop
+        m_anderson[lev].define(slice_ba, slice_dm, m_slices_nguards, 2,
+                               Hipace::m_predcorr_anderson_depth, comm_xy);
+    }
+
     // The Poisson solver operates on transverse slices only.
     // The constructor takes the BoxArray and the DistributionMap of a slice,
     // so the FFTPlans are built on a slice.
-    if (m_do_dirichlet_poisson){
+    if (m_do_dirichlet_poisson && m_use_tridiagonal_poisson){
+        m_poisson_solver.push_back(std::unique_ptr<FFTPoissonSolverDirichletTridiagonal>(
+            new FFTPoissonSolverDirichletTridiagonal(
+                getSlices(lev, WhichSlice::This).boxArray(),
+                getSlices(lev, WhichSlice::This).DistributionMap(),
+                geom[lev])) );
+    } else if (m_do_dirichlet_poisson){
         m_poisson_solver.push_back(std::unique_ptr<FFTPoissonSolverDirichlet>(
             new FFTPoissonSolverDirichlet(getSlices(lev, WhichSlice::This).boxArray(),
                                           getSlices(lev, WhichSlice::This).DistributionMap(),
@@ -76,6 +104,41 @@ Fields::AllocData (
     }
 }
 
+uint8_t*
+Fields::getIonMaskWorkspace (const amrex::Long n)
+{
+    if (n > static_cast<amrex::Long>(m_ion_mask.size())) {
+        m_ion_mask.resize(n);
+        UpdateWorkspaceBytes();
+    }
+    uint8_t* const p_ion_mask = m_ion_mask.dataPtr();
+    amrex::ParallelFor(n, [=] AMREX_GPU_DEVICE (amrex::Long i) noexcept { p_ion_mask[i] = 0; });
+    return p_ion_mask;
+}
+
+int const*
+Fields::getCommFlagsWorkspace (const int n)
+{
+    if (n > static_cast<int>(m_comm_flags.size())) {
+        m_comm_flags.resize(n, 1);
+        UpdateWorkspaceBytes();
+    }
+    return m_comm_flags.dataPtr();
+}
+
+void
+Fields::UpdateWorkspaceBytes ()
+{
+    std::size_t bytes = m_ion_mask.capacity()*sizeof(uint8_t) + m_comm_flags.capacity()*sizeof(int);
+    for (auto const& mf : m_workspace) {
+        if (!mf.ok()) continue;
+        for (amrex::MFIter mfi(mf); mfi.isValid(); ++mfi) {
+            bytes += mf[mfi].nBytes();
+        }
+    }
+    m_workspace_peak_bytes = std::max(m_workspace_peak_bytes, bytes);
+}
+
 /** \brief inner version of derivative */
 template<int dir>
 struct derivative_inner {
@@ -342,7 +405,7 @@ Fields::Copy (const int lev, const int i_slice, const amrex::Geometry& diag_geom
     diag_box.setBig(2, amrex::min(diag_box.bigEnd(2), k_stop));
     if (diag_box.isEmpty()) return;
 
-    auto& slice_mf = m_slices[lev][WhichSlice::This];
+    auto& slice_mf = getSlices(lev, WhichSlice::This);
     auto slice_func = interpolated_field_xy<depos_order_xy, guarded_field>{slice_mf, calc_geom};
 
     // Finally actual kernel: Interpolation in x, y, z of zero-extended fields
@@ -384,21 +447,13 @@ Fields::ShiftSlices (int nlev, int islice, amrex::Geometry geom, amrex::Real pat
         if (pos < patch_lo || pos > patch_hi) continue;
     }
 
-    // shift Bx, By
-    amrex::MultiFab::Copy(
-        getSlices(lev, WhichSlice::Previous2), getSlices(lev, WhichSlice::Previous1),
-        Comps[WhichSlice::Previous1]["Bx"], Comps[WhichSlice::Previous2]["Bx"],
-        2, m_slices_nguards);
-    // shift Ez, Bx, By, Bz, jx, jx_beam, jy, jy_beam
-    amrex::MultiFab::Copy(
-        getSlices(lev, WhichSlice::Previous1), getSlices(lev, WhichSlice::This),
-        Comps[WhichSlice::This]["Ez"], Comps[WhichSlice::Previous1]["Ez"],
-        8, m_slices_nguards);
-    // shift rho, Psi
-    amrex::MultiFab::Copy(
-        getSlices(lev, WhichSlice::Previous1), getSlices(lev, WhichSlice::This),
-        Comps[WhichSlice::This]["rho"], Comps[WhichSlice::Previous1]["rho"],
-        2, m_slices_nguards);
+    // rotate This -> Previous1 -> Previous2 -> This. No data is copied, the new This slice
+    // contains the old Previous2 data and is reset before being used.
+    std::array<int, m_nslices>& storage = m_slice_storage[lev];
+    const int old_previous2 = storage[WhichSlice::Previous2];
+    storage[WhichSlice::Previous2] = storage[WhichSlice::Previous1];
+    storage[WhichSlice::Previous1] = storage[WhichSlice::This];
+    storage[WhichSlice::This] = old_previous2;
     }
 }
 
@@ -408,10 +463,10 @@ Fields::AddRhoIons (const int lev, bool inverse)
     HIPACE_PROFILE("Fields::AddRhoIons()");
     if (!inverse){
         amrex::MultiFab::Add(getSlices(lev, WhichSlice::This), getSlices(lev, WhichSlice::RhoIons),
-            Comps[WhichSlice::RhoIons]["rho"], Comps[WhichSlice::This]["rho"], 1, m_slices_nguards);
+            FieldComps::RhoIons::rho, FieldComps::This::rho, 1, m_slices_nguards);
     } else {
         amrex::MultiFab::Subtract(getSlices(lev, WhichSlice::This), getSlices(lev, WhichSlice::RhoIons),
-            Comps[WhichSlice::RhoIons]["rho"], Comps[WhichSlice::This]["rho"], 1, m_slices_nguards);
+            FieldComps::RhoIons::rho, FieldComps::This::rho, 1, m_slices_nguards);
     }
 }
 
@@ -421,12 +476,18 @@ Fields::AddBeamCurrents (const int lev, const int which_slice)
     HIPACE_PROFILE("Fields::AddBeamCurrents()");
     amrex::MultiFab& S = getSlices(lev, which_slice);
     // we add the beam currents to the full currents, as mostly the full currents are needed
-    amrex::MultiFab::Add(S, S, Comps[which_slice]["jx_beam"], Comps[which_slice]["jx"], 1,
-                         m_slices_nguards);
-    amrex::MultiFab::Add(S, S, Comps[which_slice]["jy_beam"], Comps[which_slice]["jy"], 1,
-                         m_slices_nguards);
     if (which_slice == WhichSlice::This) {
-        amrex::MultiFab::Add(S, S, Comps[which_slice]["jz_beam"], Comps[which_slice]["jz"], 1,
+        amrex::MultiFab::Add(S, S, FieldComps::This::jx_beam, FieldComps::This::jx, 1,
+                             m_slices_nguards);
+        amrex::MultiFab::Add(S, S, FieldComps::This::jy_beam, FieldComps::This::jy, 1,
+                             m_slices_nguards);
+        amrex::MultiFab::Add(S, S, FieldComps::This::jz_beam, FieldComps::This::jz, 1,
+                             m_slices_nguards);
+    } else {
+        AMREX_ALWAYS_ASSERT(which_slice == WhichSlice::Next);
+        amrex::MultiFab::Add(S, S, FieldComps::Next::jx_beam, FieldComps::Next::jx, 1,
+                             m_slices_nguards);
+        amrex::MultiFab::Add(S, S, FieldComps::Next::jy_beam, FieldComps::Next::jy, 1,
                              m_slices_nguards);
     }
 }
@@ -491,7 +552,8 @@ SetDirichletBoundaries (amrex::Array4<amrex::Real> RHS, const amrex::Box& solver
 
 void
 Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const int lev,
-                              std::string component, const int islice)
+                              const int comp_this, const int comp_prev1, const int islice,
+                              const int staging_comp)
 {
     if (lev == 0) return; // keep lev==0 boundaries zero
     HIPACE_PROFILE("Fields::SetBoundaryCondition()");
@@ -502,10 +564,10 @@ Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const
     const amrex::Real rel_z = islice_coarse - static_cast<int>(amrex::Math::floor(islice_coarse));
 
     auto solution_interp = interpolated_field_xyz<interp_order>{
-        getField(lev-1, WhichSlice::This, component),
-        getField(lev-1, WhichSlice::Previous1, component),
+        getField(lev-1, WhichSlice::This, comp_this),
+        getField(lev-1, WhichSlice::Previous1, comp_prev1),
         rel_z, geom[lev-1]};
-    amrex::MultiFab staging_area = getStagingArea(lev);
+    amrex::MultiFab staging_area = getStagingArea(lev, staging_comp);
 
     for (amrex::MFIter mfi(staging_area, false); mfi.isValid(); ++mfi)
     {
@@ -520,7 +582,7 @@ Fields::SetBoundaryCondition (amrex::Vector<amrex::Geometry> const& geom, const
 
 void
 Fields::InterpolateFromLev0toLev1 (amrex::Vector<amrex::Geometry> const& geom, const int lev,
-                                   std::string component, const int islice,
+                                   const int comp_this, const int comp_prev1, const int islice,
                                    const amrex::IntVect outer_edge, const amrex::IntVect inner_edge)
 {
     if (lev == 0) return; // only interpolate boundaries to lev 1
@@ -533,10 +595,10 @@ Fields::InterpolateFromLev0toLev1 (amrex::Vector<amrex::Geometry> const& geom, c
     const amrex::Real rel_z = islice_coarse - static_cast<int>(amrex::Math::floor(islice_coarse));
 
     auto field_coarse_interp = interpolated_field_xyz<interp_order>{
-        getField(lev-1, WhichSlice::This, component),
-        getField(lev-1, WhichSlice::Previous1, component),
+        getField(lev-1, WhichSlice::This, comp_this),
+        getField(lev-1, WhichSlice::Previous1, comp_prev1),
         rel_z, geom[lev-1]};
-    amrex::MultiFab field_fine = getField(lev, WhichSlice::This, component);
+    amrex::MultiFab field_fine = getField(lev, WhichSlice::This, comp_this);
 
     for (amrex::MFIter mfi( field_fine, false); mfi.isValid(); ++mfi)
     {
@@ -583,16 +645,19 @@ Fields::SolvePoissonExmByAndEypBx (amrex::Vector<amrex::Geometry> const& geom,
 
     // Left-Hand Side for Poisson equation is Psi in the slice MF
     amrex::MultiFab lhs(getSlices(lev, WhichSlice::This), amrex::make_alias,
-                        Comps[WhichSlice::This]["Psi"], 1);
+                        FieldComps::This::Psi, 1);
 
-    InterpolateFromLev0toLev1(geom, lev, "rho", islice, m_poisson_nguards, -m_slices_nguards);
+    InterpolateFromLev0toLev1(geom, lev, FieldComps::This::rho, FieldComps::Previous1::rho,
+                              islice, m_poisson_nguards, -m_slices_nguards);
 
     // calculating the right-hand side 1/episilon0 * -(rho-Jz/c)
     LinCombination(m_poisson_nguards, getStagingArea(lev),
-                   1._rt/(phys_const.c*phys_const.ep0), getField(lev, WhichSlice::This, "jz"),
-                   -1._rt/(phys_const.ep0), getField(lev, WhichSlice::This, "rho"));
+                   1._rt/(phys_const.c*phys_const.ep0),
+                   getField(lev, WhichSlice::This, FieldComps::This::jz),
+                   -1._rt/(phys_const.ep0),
+                   getField(lev, WhichSlice::This, FieldComps::This::rho));
 
-    SetBoundaryCondition(geom, lev, "Psi", islice);
+    SetBoundaryCondition(geom, lev, FieldComps::This::Psi, FieldComps::Previous1::Psi, islice);
     m_poisson_solver[lev]->SolvePoissonEquation(lhs);
 
     /* ---------- Transverse FillBoundary Psi ---------- */
@@ -600,12 +665,13 @@ Fields::SolvePoissonExmByAndEypBx (amrex::Vector<amrex::Geometry> const& geom,
     lhs.FillBoundary(geom[lev].periodicity());
     amrex::ParallelContext::pop();
 
-    InterpolateFromLev0toLev1(geom, lev, "Psi", islice, m_slices_nguards, m_poisson_nguards);
+    InterpolateFromLev0toLev1(geom, lev, FieldComps::This::Psi, FieldComps::Previous1::Psi,
+                              islice, m_slices_nguards, m_poisson_nguards);
 
     // Compute ExmBy = -d/dx psi and EypBx = -d/dy psi
-    amrex::MultiFab f_ExmBy = getField(lev, WhichSlice::This, "ExmBy");
-    amrex::MultiFab f_EypBx = getField(lev, WhichSlice::This, "EypBx");
-    amrex::MultiFab f_Psi = getField(lev, WhichSlice::This, "Psi");
+    amrex::MultiFab f_ExmBy = getField(lev, WhichSlice::This, FieldComps::This::ExmBy);
+    amrex::MultiFab f_EypBx = getField(lev, WhichSlice::This, FieldComps::This::EypBx);
+    amrex::MultiFab f_Psi = getField(lev, WhichSlice::This, FieldComps::This::Psi);
 
 #ifdef AMREX_USE_OMP
 #pragma omp parallel if (amrex::Gpu::notInLaunchRegion())
@@ -631,105 +697,87 @@ Fields::SolvePoissonExmByAndEypBx (amrex::Vector<amrex::Geometry> const& geom,
 
 
 void
-Fields::SolvePoissonEz (amrex::Vector<amrex::Geometry> const& geom, const int lev, const int islice)
+Fields::SolvePoissonEzAndBz (amrex::Vector<amrex::Geometry> const& geom, const int lev,
+                             const int islice)
 {
-    /* Solves Laplacian(Ez) =  1/(episilon0 *c0 )*(d_x(jx) + d_y(jy)) */
-    HIPACE_PROFILE("Fields::SolvePoissonEz()");
+    /* Solves Laplacian(Ez) =  1/(episilon0 *c0 )*(d_x(jx) + d_y(jy))
+     * and Laplacian(Bz) = mu_0*(d_y(jx) - d_x(jy)) in one batch */
+    HIPACE_PROFILE("Fields::SolvePoissonEzAndBz()");
 
     PhysConst phys_const = get_phys_const();
-    // Left-Hand Side for Poisson equation is Bz in the slice MF
-    amrex::MultiFab lhs(getSlices(lev, WhichSlice::This), amrex::make_alias,
-                        Comps[WhichSlice::This]["Ez"], 1);
+    // Left-Hand Side for Poisson equations are Ez and Bz in the slice MF
+    amrex::MultiFab lhs_Ez(getSlices(lev, WhichSlice::This), amrex::make_alias,
+                           FieldComps::This::Ez, 1);
+    amrex::MultiFab lhs_Bz(getSlices(lev, WhichSlice::This), amrex::make_alias,
+                           FieldComps::This::Bz, 1);
 
     // Right-Hand Side for Poisson equation: compute 1/(episilon0 *c0 )*(d_x(jx) + d_y(jy))
-    // from the slice MF, and store in the staging area of poisson_solver
-    LinCombination(m_poisson_nguards, getStagingArea(lev),
+    // from the slice MF, and store in component 0 of the staging area of poisson_solver
+    LinCombination(m_poisson_nguards, getStagingArea(lev, 0),
                    1._rt/(phys_const.ep0*phys_const.c),
-                   derivative<Direction::x>{getField(lev, WhichSlice::This, "jx"), geom[lev]},
+                   derivative<Direction::x>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jx), geom[lev]},
                    1._rt/(phys_const.ep0*phys_const.c),
-                   derivative<Direction::y>{getField(lev, WhichSlice::This, "jy"), geom[lev]});
-
-    SetBoundaryCondition(geom, lev, "Ez", islice);
-    // Solve Poisson equation.
-    // The RHS is in the staging area of poisson_solver.
-    // The LHS will be returned as lhs.
-    m_poisson_solver[lev]->SolvePoissonEquation(lhs);
-}
-
-void
-Fields::SolvePoissonBx (amrex::MultiFab& Bx_iter, amrex::Vector<amrex::Geometry> const& geom,
-                        const int lev, const int islice)
-{
-    /* Solves Laplacian(Bx) = mu_0*(- d_y(jz) + d_z(jy) ) */
-    HIPACE_PROFILE("Fields::SolvePoissonBx()");
-
-    PhysConst phys_const = get_phys_const();
+                   derivative<Direction::y>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jy), geom[lev]});
 
-    // Right-Hand Side for Poisson equation: compute -mu_0*d_y(jz) from the slice MF,
-    // and store in the staging area of poisson_solver
-    LinCombination(m_poisson_nguards, getStagingArea(lev),
-                   -phys_const.mu0,
-                   derivative<Direction::y>{getField(lev, WhichSlice::This, "jz"), geom[lev]},
+    // Right-Hand Side for Poisson equation: compute mu_0*(d_y(jx) - d_x(jy))
+    // from the slice MF, and store in component 1 of the staging area of poisson_solver
+    LinCombination(m_poisson_nguards, getStagingArea(lev, 1),
                    phys_const.mu0,
-                   derivative<Direction::z>{getField(lev, WhichSlice::Previous1, "jy"),
-                   getField(lev, WhichSlice::Next, "jy"), geom[lev]});
-
-    SetBoundaryCondition(geom, lev, "Bx", islice);
-    // Solve Poisson equation.
-    // The RHS is in the staging area of poisson_solver.
-    // The LHS will be returned as Bx_iter.
-    m_poisson_solver[lev]->SolvePoissonEquation(Bx_iter);
+                   derivative<Direction::y>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jx), geom[lev]},
+                   -phys_const.mu0,
+                   derivative<Direction::x>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jy), geom[lev]});
+
+    SetBoundaryCondition(geom, lev, FieldComps::This::Ez, FieldComps::Previous1::Ez, islice, 0);
+    SetBoundaryCondition(geom, lev, FieldComps::This::Bz, FieldComps::Previous1::Bz, islice, 1);
+    // Solve both Poisson equations with one batched transform.
+    // The RHS are in the staging area of poisson_solver.
+    // The LHS will be returned as lhs_Ez and lhs_Bz.
+    m_poisson_solver[lev]->SolvePoissonEquation({&lhs_Ez, &lhs_Bz});
 }
 
 void
-Fields::SolvePoissonBy (amrex::MultiFab& By_iter, amrex::Vector<amrex::Geometry> const& geom,
-                        const int lev, const int islice)
+Fields::SolvePoissonBxAndBy (amrex::MultiFab& Bx_iter, amrex::MultiFab& By_iter,
+                             amrex::Vector<amrex::Geometry> const& geom, const int lev,
+                             const int islice)
 {
-    /* Solves Laplacian(By) = mu_0*(d_x(jz) - d_z(jx) ) */
-    HIPACE_PROFILE("Fields::SolvePoissonBy()");
+    /* Solves Laplacian(Bx) = mu_0*(- d_y(jz) + d_z(jy) )
+     * and Laplacian(By) = mu_0*(d_x(jz) - d_z(jx) ) in one batch */
+    HIPACE_PROFILE("Fields::SolvePoissonBxAndBy()");
 
     PhysConst phys_const = get_phys_const();
 
-    // Right-Hand Side for Poisson equation: compute mu_0*d_x(jz) from the slice MF,
-    // and store in the staging area of poisson_solver
-    LinCombination(m_poisson_nguards, getStagingArea(lev),
-                   phys_const.mu0,
-                   derivative<Direction::x>{getField(lev, WhichSlice::This, "jz"), geom[lev]},
+    // Right-Hand Side for Poisson equation: compute -mu_0*d_y(jz) + mu_0*d_z(jy) from the
+    // slice MF, and store in component 0 of the staging area of poisson_solver
+    LinCombination(m_poisson_nguards, getStagingArea(lev, 0),
                    -phys_const.mu0,
-                   derivative<Direction::z>{getField(lev, WhichSlice::Previous1, "jx"),
-                   getField(lev, WhichSlice::Next, "jx"), geom[lev]});
-
-    SetBoundaryCondition(geom, lev, "By", islice);
-    // Solve Poisson equation.
-    // The RHS is in the staging area of poisson_solver.
-    // The LHS will be returned as By_iter.
-    m_poisson_solver[lev]->SolvePoissonEquation(By_iter);
-}
-
-void
-Fields::SolvePoissonBz (amrex::Vector<amrex::Geometry> const& geom, const int lev, const int islice)
-{
-    /* Solves Laplacian(Bz) = mu_0*(d_y(jx) - d_x(jy)) */
-    HIPACE_PROFILE("Fields::SolvePoissonBz()");
-
-    PhysConst phys_const = get_phys_const();
-    // Left-Hand Side for Poisson equation is Bz in the slice MF
-    amrex::MultiFab lhs(getSlices(lev, WhichSlice::This), amrex::make_alias,
-                        Comps[WhichSlice::This]["Bz"], 1);
+                   derivative<Direction::y>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jz), geom[lev]},
+                   phys_const.mu0,
+                   derivative<Direction::z>{
+                       getField(lev, WhichSlice::Previous1, FieldComps::Previous1::jy),
+                       getField(lev, WhichSlice::Next, FieldComps::Next::jy), geom[lev]});
 
-    // Right-Hand Side for Poisson equation: compute mu_0*(d_y(jx) - d_x(jy))
-    // from the slice MF, and store in the staging area of m_poisson_solver
-    LinCombination(m_poisson_nguards, getStagingArea(lev),
+    // Right-Hand Side for Poisson equation: compute mu_0*d_x(jz) - mu_0*d_z(jx) from the
+    // slice MF, and store in component 1 of the staging area of poisson_solver
+    LinCombination(m_poisson_nguards, getStagingArea(lev, 1),
                    phys_const.mu0,
-                   derivative<Direction::y>{getField(lev, WhichSlice::This, "jx"), geom[lev]},
+                   derivative<Direction::x>{
+                       getField(lev, WhichSlice::This, FieldComps::This::jz), geom[lev]},
                    -phys_const.mu0,
-                   derivative<Direction::x>{getField(lev, WhichSlice::This, "jy"), geom[lev]});
-
-    SetBoundaryCondition(geom, lev, "Bz", islice);
-    // Solve Poisson equation.
-    // The RHS is in the staging area of m_poisson_solver.
-    // The LHS will be returned as lhs.
-    m_poisson_solver[lev]->SolvePoissonEquation(lhs);
+                   derivative<Direction::z>{
+                       getField(lev, WhichSlice::Previous1, FieldComps::Previous1::jx),
+                       getField(lev, WhichSlice::Next, FieldComps::Next::jx), geom[lev]});
+
+    SetBoundaryCondition(geom, lev, FieldComps::This::Bx, FieldComps::Previous1::Bx, islice, 0);
+    SetBoundaryCondition(geom, lev, FieldComps::This::By, FieldComps::Previous1::By, islice, 1);
+    // Solve both Poisson equations with one batched transform.
+    // The RHS are in the staging area of poisson_solver.
+    // The LHS will be returned as Bx_iter and By_iter.
+    m_poisson_solver[lev]->SolvePoissonEquation({&Bx_iter, &By_iter});
 }
 
 void
@@ -745,15 +793,19 @@ Fields::InitialBfieldGuess (const amrex::Real relative_Bfield_error,
 
     amrex::MultiFab::LinComb(
         getSlices(lev, WhichSlice::This),
-        1._rt+mix_factor_init_guess, getSlices(lev, WhichSlice::Previous1), Comps[WhichSlice::Previous1]["Bx"],
-        -mix_factor_init_guess, getSlices(lev, WhichSlice::Previous2), Comps[WhichSlice::Previous2]["Bx"],
-        Comps[WhichSlice::This]["Bx"], 1, m_slices_nguards);
+        1._rt+mix_factor_init_guess, getSlices(lev, WhichSlice::Previous1),
+        FieldComps::Previous1::Bx,
+        -mix_factor_init_guess, getSlices(lev, WhichSlice::Previous2),
+        FieldComps::Previous2::Bx,
+        FieldComps::This::Bx, 1, m_slices_nguards);
 
     amrex::MultiFab::LinComb(
         getSlices(lev, WhichSlice::This),
-        1._rt+mix_factor_init_guess, getSlices(lev, WhichSlice::Previous1), Comps[WhichSlice::Previous1]["By"],
-        -mix_factor_init_guess, getSlices(lev, WhichSlice::Previous2), Comps[WhichSlice::Previous2]["By"],
-        Comps[WhichSlice::This]["By"], 1, m_slices_nguards);
+        1._rt+mix_factor_init_guess, getSlices(lev, WhichSlice::Previous1),
+        FieldComps::Previous1::By,
+        -mix_factor_init_guess, getSlices(lev, WhichSlice::Previous2),
+        FieldComps::Previous2::By,
+        FieldComps::This::By, 1, m_slices_nguards);
 }
 
 void
@@ -806,6 +858,19 @@ Fields::MixAndShiftBfields (const amrex::MultiFab& B_iter, amrex::MultiFab& B_pr
 
 }
 
+void
+Fields::AndersonMixBfields (const amrex::MultiFab& Bx_iter, const amrex::MultiFab& By_iter,
+                            const amrex::Real predcorr_B_mixing_factor, const int lev)
+{
+    HIPACE_PROFILE("Fields::AndersonMixBfields()");
+
+    amrex::MultiFab Bx(getSlices(lev, WhichSlice::This), amrex::make_alias,
+                       FieldComps::This::Bx, 1);
+    amrex::MultiFab By(getSlices(lev, WhichSlice::This), amrex::make_alias,
+                       FieldComps::This::By, 1);
+    m_anderson[lev].Mix({&Bx, &By}, {&Bx_iter, &By_iter}, predcorr_B_mixing_factor);
+}
+
 amrex::Real
 Fields::ComputeRelBFieldError (
     const amrex::MultiFab& Bx, const amrex::MultiFab& By, const amrex::MultiFab& Bx_iter,
@@ -3,6 +3,8 @@
 #include "utils/Constants.H"
 #include "utils/HipaceProfilerWrapper.H"
 
+#include <AMReX_ParallelDescriptor.H>
+
 FFTPoissonSolverDirichlet::FFTPoissonSolverDirichlet (
     amrex::BoxArray const& realspace_ba,
     amrex::DistributionMapping const& dm,
@@ -28,11 +30,11 @@ FFTPoissonSolverDirichlet::define (amrex::BoxArray const& a_realspace_ba,
     // These arrays will store the data just before/after the FFT
     // The stagingArea is also created from 0 to nx, because the real space array may have
     // an offset for levels > 0
-    m_stagingArea = amrex::MultiFab(a_realspace_ba, dm, 1, Fields::m_poisson_nguards);
-    m_tmpSpectralField = amrex::MultiFab(a_realspace_ba, dm, 1, Fields::m_poisson_nguards);
+    // Both have m_max_ncomp components to solve several Poisson equations in one batch
+    m_stagingArea = amrex::MultiFab(a_realspace_ba, dm, m_max_ncomp, Fields::m_poisson_nguards);
+    m_tmpSpectralField = amrex::MultiFab(a_realspace_ba, dm, m_max_ncomp,
+                                         Fields::m_poisson_nguards);
     m_eigenvalue_matrix = amrex::MultiFab(a_realspace_ba, dm, 1, Fields::m_poisson_nguards);
-    m_stagingArea.setVal(0.0, Fields::m_poisson_nguards); // this is not required
-    m_tmpSpectralField.setVal(0.0, Fields::m_poisson_nguards);
 
     // This must be true even for parallel FFT.
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_stagingArea.local_size() == 1,
@@ -73,54 +75,71 @@ FFTPoissonSolverDirichlet::define (amrex::BoxArray const& a_realspace_ba,
                 });
     }
 
-    // Allocate and initialize the FFT plans
-    m_plan = AnyDST::DSTplans(m_spectralspace_ba, dm);
-    // Loop over boxes and allocate the corresponding plan
-    // for each box owned by the local MPI proc
-    for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
-        // Note: the size of the real-space box and spectral-space box
-        // differ when using real-to-complex FFT. When initializing
-        // the FFT plan, the valid dimensions are those of the real-space box.
-        amrex::IntVect fft_size = fft_box.length();
-        m_plan[mfi] = AnyDST::CreatePlan(
-            fft_size, &m_stagingArea[mfi], &m_tmpSpectralField[mfi]);
-    }
+    // Allocate and initialize the FFT plans, one set of plans per batch size.
+    // Every rank creates the same plans, so the FFTW wisdom is shared over all ranks.
+    m_plans.resize(m_max_ncomp);
+    AnyFFT::PlanWithWisdom(fft_box.length(), amrex::ParallelDescriptor::Communicator(), [&] () {
+        for (int ncomp = 1; ncomp <= m_max_ncomp; ++ncomp) {
+            m_plans[ncomp-1] = AnyDST::DSTplans(m_spectralspace_ba, dm);
+            // Loop over boxes and allocate the corresponding plan
+            // for each box owned by the local MPI proc
+            for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
+                // Note: the size of the real-space box and spectral-space box
+                // differ when using real-to-complex FFT. When initializing
+                // the FFT plan, the valid dimensions are those of the real-space box.
+                amrex::IntVect fft_size = fft_box.length();
+                m_plans[ncomp-1][mfi] = AnyDST::CreatePlan(
+                    fft_size, &m_stagingArea[mfi], &m_tmpSpectralField[mfi], ncomp);
+            }
+        }
+    });
+
+    // Planning with FFTW_MEASURE or more overwrites the arrays, so they are initialized afterwards
+    m_stagingArea.setVal(0.0, Fields::m_poisson_nguards); // this is not required
+    m_tmpSpectralField.setVal(0.0, Fields::m_poisson_nguards);
 }
 
 
 void
-FFTPoissonSolverDirichlet::SolvePoissonEquation (amrex::MultiFab& lhs_mf)
+FFTPoissonSolverDirichlet::SolvePoissonEquation (amrex::Vector<amrex::MultiFab*> const& lhs_mfs)
 {
     HIPACE_PROFILE("FFTPoissonSolverDirichlet::SolvePoissonEquation()");
 
+    const int ncomp = lhs_mfs.size();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp >= 1 && ncomp <= m_max_ncomp,
+                                     "Number of batched Poisson equations not supported");
+
     // Loop over boxes
     for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
 
         // Perform Fourier transform from the staging area to `tmpSpectralField`
-        AnyDST::Execute<AnyDST::direction::forward>(m_plan[mfi]);
+        AnyDST::Execute<AnyDST::direction::forward>(m_plans[ncomp-1][mfi]);
 
         // Solve Poisson equation in Fourier space:
         // Multiply `tmpSpectralField` by eigenvalue_matrix
         amrex::Array4<amrex::Real> tmp_cmplx_arr = m_tmpSpectralField.array(mfi);
         amrex::Array4<amrex::Real> eigenvalue_matrix = m_eigenvalue_matrix.array(mfi);
 
-        amrex::ParallelFor( m_tmpSpectralField[mfi].box(),
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                tmp_cmplx_arr(i,j,k) *= eigenvalue_matrix(i,j,k);
+        amrex::ParallelFor( m_tmpSpectralField[mfi].box(), ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                tmp_cmplx_arr(i,j,k,n) *= eigenvalue_matrix(i,j,k);
             });
 
         // Perform Fourier transform from `tmpSpectralField` to the staging area
-        AnyDST::Execute<AnyDST::direction::backward>(m_plan[mfi]);
+        AnyDST::Execute<AnyDST::direction::backward>(m_plans[ncomp-1][mfi]);
 
-        // Copy from the staging area to output array (and normalize)
+        // Copy from the staging area to output arrays (and normalize)
         amrex::Array4<amrex::Real> tmp_real_arr = m_stagingArea.array(mfi);
-        amrex::Array4<amrex::Real> lhs_arr = lhs_mf.array(mfi);
-        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lhs_mf.size() == 1,
-                                         "Slice MFs must be defined on one box only");
-        amrex::ParallelFor( lhs_mf[mfi].box() & m_stagingArea[mfi].box(),
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        amrex::GpuArray<amrex::Array4<amrex::Real>, m_max_ncomp> lhs_arr;
+        for (int n = 0; n < ncomp; ++n) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lhs_mfs[n]->size() == 1,
+                                             "Slice MFs must be defined on one box only");
+            lhs_arr[n] = lhs_mfs[n]->array(mfi);
+        }
+        amrex::ParallelFor( (*lhs_mfs[0])[mfi].box() & m_stagingArea[mfi].box(), ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
                 // Copy field
-                lhs_arr(i,j,k) = tmp_real_arr(i,j,k);
+                lhs_arr[n](i,j,k) = tmp_real_arr(i,j,k,n);
             });
     }
 }
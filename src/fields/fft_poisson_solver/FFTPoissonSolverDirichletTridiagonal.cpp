@@ -0,0 +1,158 @@
+#include "FFTPoissonSolverDirichletTridiagonal.H"
+#include "fft/AnyDST.H"
+#include "fields/Fields.H"
+#include "utils/Constants.H"
+#include "utils/HipaceProfilerWrapper.H"
+
+#include <AMReX_ParallelDescriptor.H>
+
+FFTPoissonSolverDirichletTridiagonal::FFTPoissonSolverDirichletTridiagonal (
+    amrex::BoxArray const& realspace_ba,
+    amrex::DistributionMapping const& dm,
+    amrex::Geometry const& gm )
+{
+    define(realspace_ba, dm, gm);
+}
+
+void
+FFTPoissonSolverDirichletTridiagonal::define (amrex::BoxArray const& a_realspace_ba,
+                                              amrex::DistributionMapping const& dm,
+                                              amrex::Geometry const& gm )
+{
+    using namespace amrex::literals;
+
+    HIPACE_PROFILE("FFTPoissonSolverDirichletTridiagonal::define()");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(a_realspace_ba.size() == 1, "Parallel FFT not supported yet");
+
+    m_spectralspace_ba = a_realspace_ba;
+
+    // Allocate temporary arrays - in real space and spectral space
+    // Both have m_max_ncomp components to solve several Poisson equations in one batch
+    m_stagingArea = amrex::MultiFab(a_realspace_ba, dm, m_max_ncomp, Fields::m_poisson_nguards);
+    m_tmpSpectralField = amrex::MultiFab(a_realspace_ba, dm, m_max_ncomp,
+                                         Fields::m_poisson_nguards);
+    m_thomas_coefs = amrex::MultiFab(a_realspace_ba, dm, 2, Fields::m_poisson_nguards);
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_stagingArea.local_size() == 1,
+                                     "There should be only one box locally.");
+
+    const amrex::Box fft_box = m_stagingArea[0].box();
+    const auto dx = gm.CellSizeArray();
+    const amrex::Real dxsquared = dx[0]*dx[0];
+    m_inv_dysquared = 1._rt/(dx[1]*dx[1]);
+    const amrex::Real inv_dysquared = m_inv_dysquared;
+    const amrex::Real sine_x_factor = MathConst::pi / ( 2. * ( fft_box.length(0) + 1 ));
+    const int jlo = fft_box.smallEnd(1);
+    const int jhi = fft_box.bigEnd(1);
+
+    // The tridiagonal systems are solved for one j at a time, so the loops run over one row
+    amrex::Box row_box = fft_box;
+    row_box.setBig(1, jlo);
+
+    // Calculate the coefficients of the Thomas algorithm. For x mode i, the system along y is
+    // (F(j-1) - 2 F(j) + F(j+1))/dy^2 + lambda_x(i) F(j) = S(j), with F = 0 outside of the box.
+    // It is strictly diagonally dominant, so no pivoting is needed.
+    for (amrex::MFIter mfi(m_thomas_coefs); mfi.isValid(); ++mfi ){
+        amrex::Array4<amrex::Real> coefs = m_thomas_coefs.array(mfi);
+        const int ilo = fft_box.smallEnd(0);
+        amrex::ParallelFor(
+            row_box, [=] AMREX_GPU_DEVICE (int i, int, int k) noexcept
+                {
+                    /* fast poisson solver diagonal x coeffs */
+                    const amrex::Real sinex_sq = sin(( i - ilo + 1 ) * sine_x_factor) * sin(( i - ilo + 1 ) * sine_x_factor);
+                    const amrex::Real diag = -4.0_rt * sinex_sq / dxsquared - 2._rt * inv_dysquared;
+                    amrex::Real cprime = 0._rt;
+                    for (int j = jlo; j <= jhi; ++j) {
+                        const amrex::Real inv_pivot = 1._rt / ( diag - inv_dysquared * cprime );
+                        cprime = inv_dysquared * inv_pivot;
+                        coefs(i,j,k,0) = cprime;
+                        coefs(i,j,k,1) = inv_pivot;
+                    }
+                });
+    }
+
+    // Allocate and initialize the DST plans along x, one set of plans per batch size.
+    // Every rank creates the same plans, so the FFTW wisdom is shared over all ranks.
+    m_plans.resize(m_max_ncomp);
+    AnyFFT::PlanWithWisdom(fft_box.length(), amrex::ParallelDescriptor::Communicator(), [&] () {
+        for (int ncomp = 1; ncomp <= m_max_ncomp; ++ncomp) {
+            m_plans[ncomp-1] = AnyDST::DSTplans(m_spectralspace_ba, dm);
+            for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
+                m_plans[ncomp-1][mfi] = AnyDST::CreatePlan1D(
+                    fft_box.length(), &m_stagingArea[mfi], &m_tmpSpectralField[mfi], ncomp);
+            }
+        }
+    });
+
+    // Planning with FFTW_MEASURE or more overwrites the arrays, so they are initialized afterwards
+    m_stagingArea.setVal(0.0, Fields::m_poisson_nguards); // this is not required
+    m_tmpSpectralField.setVal(0.0, Fields::m_poisson_nguards);
+}
+
+
+void
+FFTPoissonSolverDirichletTridiagonal::SolvePoissonEquation (
+    amrex::Vector<amrex::MultiFab*> const& lhs_mfs)
+{
+    using namespace amrex::literals;
+
+    HIPACE_PROFILE("FFTPoissonSolverDirichletTridiagonal::SolvePoissonEquation()");
+
+    const int ncomp = lhs_mfs.size();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp >= 1 && ncomp <= m_max_ncomp,
+                                     "Number of batched Poisson equations not supported");
+
+    // Loop over boxes
+    for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
+
+        // Perform Fourier transform along x from the staging area to `tmpSpectralField`
+        AnyDST::Execute<AnyDST::direction::forward>(m_plans[ncomp-1][mfi]);
+
+        const amrex::Box fft_box = m_tmpSpectralField[mfi].box();
+        const int jlo = fft_box.smallEnd(1);
+        const int jhi = fft_box.bigEnd(1);
+        amrex::Box row_box = fft_box;
+        row_box.setBig(1, jlo);
+
+        // Normalization of FFTW's 'DST-I' discrete sine transform (FFTW_RODFT00) along x
+        const amrex::Real norm_fac = 0.5_rt / ( fft_box.length(0) + 1 );
+        // Sub-diagonal of the tridiagonal systems
+        const amrex::Real sub_diag = m_inv_dysquared;
+
+        // Solve the tridiagonal system along y of every x mode in place in `tmpSpectralField`
+        amrex::Array4<amrex::Real> tmp_cmplx_arr = m_tmpSpectralField.array(mfi);
+        amrex::Array4<amrex::Real const> coefs = m_thomas_coefs.const_array(mfi);
+
+        amrex::ParallelFor( row_box, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int, int k, int n) noexcept {
+                // Forward elimination
+                amrex::Real dprime = 0._rt;
+                for (int j = jlo; j <= jhi; ++j) {
+                    dprime = ( norm_fac * tmp_cmplx_arr(i,j,k,n) - sub_diag * dprime )
+                             * coefs(i,j,k,1);
+                    tmp_cmplx_arr(i,j,k,n) = dprime;
+                }
+                // Back substitution
+                for (int j = jhi-1; j >= jlo; --j) {
+                    tmp_cmplx_arr(i,j,k,n) -= coefs(i,j,k,0) * tmp_cmplx_arr(i,j+1,k,n);
+                }
+            });
+
+        // Perform Fourier transform along x from `tmpSpectralField` to the staging area
+        AnyDST::Execute<AnyDST::direction::backward>(m_plans[ncomp-1][mfi]);
+
+        // Copy from the staging area to output arrays
+        amrex::Array4<amrex::Real> tmp_real_arr = m_stagingArea.array(mfi);
+        amrex::GpuArray<amrex::Array4<amrex::Real>, m_max_ncomp> lhs_arr;
+        for (int n = 0; n < ncomp; ++n) {
+            AMREX_ALWAYS_ASSERT_WITH_MESSAGE(lhs_mfs[n]->size() == 1,
+                                             "Slice MFs must be defined on one box only");
+            lhs_arr[n] = lhs_mfs[n]->array(mfi);
+        }
+        amrex::ParallelFor( (*lhs_mfs[0])[mfi].box() & m_stagingArea[mfi].box(), ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                // Copy field
+                lhs_arr[n](i,j,k) = tmp_real_arr(i,j,k,n);
+            });
+    }
+}
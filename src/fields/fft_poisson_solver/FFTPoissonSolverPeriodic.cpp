@@ -3,6 +3,8 @@
 #include "utils/Constants.H"
 #include "utils/HipaceProfilerWrapper.H"
 
+#include <AMReX_ParallelDescriptor.H>
+
 FFTPoissonSolverPeriodic::FFTPoissonSolverPeriodic (
     amrex::BoxArray const& realspace_ba,
     amrex::DistributionMapping const& dm,
@@ -48,8 +50,9 @@ FFTPoissonSolverPeriodic::define ( amrex::BoxArray const& realspace_ba,
 
     // Allocate temporary arrays - in real space and spectral space
     // These arrays will store the data just before/after the FFT
-    m_stagingArea = amrex::MultiFab(realspace_ba, dm, 1, Fields::m_poisson_nguards);
-    m_tmpSpectralField = SpectralField(m_spectralspace_ba, dm, 1, 0);
+    // Both have m_max_ncomp components to solve several Poisson equations in one batch
+    m_stagingArea = amrex::MultiFab(realspace_ba, dm, m_max_ncomp, Fields::m_poisson_nguards);
+    m_tmpSpectralField = SpectralField(m_spectralspace_ba, dm, m_max_ncomp, 0);
 
     // This must be true even for parallel FFT.
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_stagingArea.local_size() == 1,
@@ -82,61 +85,80 @@ FFTPoissonSolverPeriodic::define ( amrex::BoxArray const& realspace_ba,
         });
     }
 
-    // Allocate and initialize the FFT plans
-    m_forward_plan = AnyFFT::FFTplans(m_spectralspace_ba, dm);
-    m_backward_plan = AnyFFT::FFTplans(m_spectralspace_ba, dm);
-    // Loop over boxes and allocate the corresponding plan
-    // for each box owned by the local MPI proc
-    for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
-        // Note: the size of the real-space box and spectral-space box
-        // differ when using real-to-complex FFT. When initializing
-        // the FFT plan, the valid dimensions are those of the real-space box.
-        amrex::IntVect fft_size = m_stagingArea[mfi].box().length();
-        m_forward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, m_stagingArea[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( m_tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::R2C);
-
-        m_backward_plan[mfi] = AnyFFT::CreatePlan(
-            fft_size, m_stagingArea[mfi].dataPtr(),
-            reinterpret_cast<AnyFFT::Complex*>( m_tmpSpectralField[mfi].dataPtr()),
-            AnyFFT::direction::C2R);
-    }
+    // Allocate and initialize the FFT plans, one set of plans per batch size.
+    // Every rank creates the same plans, so the FFTW wisdom is shared over all ranks.
+    m_forward_plans.resize(m_max_ncomp);
+    m_backward_plans.resize(m_max_ncomp);
+    const amrex::IntVect domain_size =
+        amrex::grow(realspace_ba.minimalBox(), Fields::m_poisson_nguards).length();
+    AnyFFT::PlanWithWisdom(domain_size, amrex::ParallelDescriptor::Communicator(), [&] () {
+        for (int ncomp = 1; ncomp <= m_max_ncomp; ++ncomp) {
+            m_forward_plans[ncomp-1] = AnyFFT::FFTplans(m_spectralspace_ba, dm);
+            m_backward_plans[ncomp-1] = AnyFFT::FFTplans(m_spectralspace_ba, dm);
+            // Loop over boxes and allocate the corresponding plan
+            // for each box owned by the local MPI proc
+            for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
+                // Note: the size of the real-space box and spectral-space box
+                // differ when using real-to-complex FFT. When initializing
+                // the FFT plan, the valid dimensions are those of the real-space box.
+                amrex::IntVect fft_size = m_stagingArea[mfi].box().length();
+                m_forward_plans[ncomp-1][mfi] = AnyFFT::CreatePlan(
+                    fft_size, m_stagingArea[mfi].dataPtr(),
+                    reinterpret_cast<AnyFFT::Complex*>( m_tmpSpectralField[mfi].dataPtr()),
+                    AnyFFT::direction::R2C, ncomp);
+
+                m_backward_plans[ncomp-1][mfi] = AnyFFT::CreatePlan(
+                    fft_size, m_stagingArea[mfi].dataPtr(),
+                    reinterpret_cast<AnyFFT::Complex*>( m_tmpSpectralField[mfi].dataPtr()),
+                    AnyFFT::direction::C2R, ncomp);
+            }
+        }
+    });
+
+    // Planning with FFTW_MEASURE or more overwrites the arrays, so they are initialized afterwards
+    m_stagingArea.setVal(0.0, Fields::m_poisson_nguards);
 }
 
 
 void
-FFTPoissonSolverPeriodic::SolvePoissonEquation (amrex::MultiFab& lhs_mf)
+FFTPoissonSolverPeriodic::SolvePoissonEquation (amrex::Vector<amrex::MultiFab*> const& lhs_mfs)
 {
     HIPACE_PROFILE("FFTPoissonSolverPeriodic::SolvePoissonEquation()");
 
+    const int ncomp = lhs_mfs.size();
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(ncomp >= 1 && ncomp <= m_max_ncomp,
+                                     "Number of batched Poisson equations not supported");
+
     // Loop over boxes
     for ( amrex::MFIter mfi(m_stagingArea); mfi.isValid(); ++mfi ){
 
         // Perform Fourier transform from the staging area to `tmpSpectralField`
-        AnyFFT::Execute(m_forward_plan[mfi]);
+        AnyFFT::Execute(m_forward_plans[ncomp-1][mfi]);
 
         // Solve Poisson equation in Fourier space:
         // Multiply `tmpSpectralField` by inv_k2
         amrex::Array4<amrex::GpuComplex<amrex::Real>> tmp_cmplx_arr = m_tmpSpectralField.array(mfi);
         amrex::Array4<amrex::Real> inv_k2_arr = m_inv_k2.array(mfi);
-        amrex::ParallelFor( m_spectralspace_ba[mfi],
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
-                tmp_cmplx_arr(i,j,k) *= -inv_k2_arr(i,j,k);
+        amrex::ParallelFor( m_spectralspace_ba[mfi], ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
+                tmp_cmplx_arr(i,j,k,n) *= -inv_k2_arr(i,j,k);
             });
 
         // Perform Fourier transform from `tmpSpectralField` to the staging area
-        AnyFFT::Execute(m_backward_plan[mfi]);
+        AnyFFT::Execute(m_backward_plans[ncomp-1][mfi]);
 
-        // Copy from the staging area to output array (and normalize)
+        // Copy from the staging area to output arrays (and normalize)
         amrex::Array4<amrex::Real> tmp_real_arr = m_stagingArea.array(mfi);
-        amrex::Array4<amrex::Real> lhs_arr = lhs_mf.array(mfi);
+        amrex::GpuArray<amrex::Array4<amrex::Real>, m_max_ncomp> lhs_arr;
+        for (int n = 0; n < ncomp; ++n) {
+            lhs_arr[n] = lhs_mfs[n]->array(mfi);
+        }
         const amrex::Box fft_box = m_stagingArea[mfi].box();
         const amrex::Real inv_N = 1./fft_box.numPts();
-        amrex::ParallelFor( fft_box,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k) noexcept {
+        amrex::ParallelFor( fft_box, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n) noexcept {
                 // Copy and normalize field
-                lhs_arr(i,j,k) = inv_N*tmp_real_arr(i,j,k);
+                lhs_arr[n](i,j,k) = inv_N*tmp_real_arr(i,j,k,n);
             });
 
     }
@@ -0,0 +1,125 @@
+#include "FFTWUtils.H"
+#include "utils/Parser.H"
+
+#include <AMReX_ParallelDescriptor.H>
+#include <AMReX_ParmParse.H>
+#include <AMReX_Print.H>
+
+#include <fftw3.h>
+
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+
+namespace FFTWUtils
+{
+#ifdef AMREX_USE_FLOAT
+    const auto VendorImportWisdomFromFilename = fftwf_import_wisdom_from_filename;
+    const auto VendorImportWisdomFromString = fftwf_import_wisdom_from_string;
+    const auto VendorExportWisdomToFilename = fftwf_export_wisdom_to_filename;
+    const auto VendorExportWisdomToString = fftwf_export_wisdom_to_string;
+    const auto VendorFree = fftwf_free;
+#else
+    const auto VendorImportWisdomFromFilename = fftw_import_wisdom_from_filename;
+    const auto VendorImportWisdomFromString = fftw_import_wisdom_from_string;
+    const auto VendorExportWisdomToFilename = fftw_export_wisdom_to_filename;
+    const auto VendorExportWisdomToString = fftw_export_wisdom_to_string;
+    const auto VendorFree = fftw_free;
+#endif
+
+    /** \brief Read hipace.fftw_plan_effort and return the corresponding FFTW planner flag */
+    static unsigned ReadPlannerFlag ()
+    {
+        amrex::ParmParse pp("hipace");
+        std::string effort = "estimate";
+        queryWithParser(pp, "fftw_plan_effort", effort);
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            effort == "estimate" || effort == "measure" ||
+            effort == "patient" || effort == "exhaustive",
+            "hipace.fftw_plan_effort must be estimate, measure, patient or exhaustive");
+
+        if (effort == "measure") return FFTW_MEASURE;
+        if (effort == "patient") return FFTW_PATIENT;
+        if (effort == "exhaustive") return FFTW_EXHAUSTIVE;
+        return FFTW_ESTIMATE;
+    }
+
+    unsigned PlannerFlag ()
+    {
+        // The input is parsed once, when the first plan is created
+        static const unsigned flag = ReadPlannerFlag();
+        return flag;
+    }
+
+    int NumThreads (const amrex::IntVect& real_size)
+    {
+#if defined(AMREX_USE_OMP) && defined(HIPACE_FFTW_OMP)
+        if (real_size[0] > 32 && real_size[1] > 32) return omp_get_max_threads();
+#else
+        amrex::ignore_unused(real_size);
+#endif
+        return 1;
+    }
+
+    std::string WisdomFileName (const amrex::IntVect& real_size, const int nthreads)
+    {
+        amrex::ParmParse pp("hipace");
+        std::string prefix = "";
+        queryWithParser(pp, "fftw_wisdom_file", prefix);
+        if (prefix.empty()) return prefix;
+
+#ifdef AMREX_USE_FLOAT
+        const std::string precision = "single";
+#else
+        const std::string precision = "double";
+#endif
+        return prefix + "_" + std::to_string(real_size[0]) + "x" + std::to_string(real_size[1])
+            + "_" + precision + "_" + std::to_string(nthreads) + "threads";
+    }
+
+    void PlanWithWisdom (const amrex::IntVect& real_size, MPI_Comm comm,
+                         const std::function<void()>& create_plans)
+    {
+        // FFTW_ESTIMATE plans do not measure anything, so there is no wisdom to share
+        if (PlannerFlag() == FFTW_ESTIMATE) {
+            create_plans();
+            return;
+        }
+
+        const std::string filename = WisdomFileName(real_size, NumThreads(real_size));
+        const int root = 0;
+        const bool is_root = amrex::ParallelDescriptor::MyProc(comm) == root;
+        std::string wisdom {};
+
+        if (is_root) {
+            if (!filename.empty() && VendorImportWisdomFromFilename(filename.c_str())) {
+                amrex::Print() << "imported FFTW wisdom from " << filename << "\n";
+            }
+
+            create_plans();
+
+            char* wisdom_str = VendorExportWisdomToString();
+            wisdom = wisdom_str;
+            VendorFree(wisdom_str);
+
+            // Several communicators may plan the same sizes, only the I/O rank writes the file
+            if (!filename.empty() && amrex::ParallelDescriptor::IOProcessor() &&
+                !VendorExportWisdomToFilename(filename.c_str())) {
+                amrex::Print() << "WARNING: could not write FFTW wisdom to " << filename << "\n";
+            }
+        }
+
+        // Share the wisdom of the root rank, so the other ranks do not measure the plans again
+        int wisdom_size = wisdom.size();
+        amrex::ParallelDescriptor::Bcast(&wisdom_size, 1, root, comm);
+        wisdom.resize(wisdom_size);
+        if (wisdom_size > 0) {
+            amrex::ParallelDescriptor::Bcast(&wisdom[0], wisdom_size, root, comm);
+        }
+
+        if (!is_root) {
+            VendorImportWisdomFromString(wisdom.c_str());
+            create_plans();
+        }
+    }
+}
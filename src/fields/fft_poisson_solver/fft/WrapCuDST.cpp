@@ -16,12 +16,11 @@ namespace AnyDST
      *
      * \param[in,out] dst destination array, odd symmetry around 0 and the middle points in x and y
      * \param[in] src source array
+     * \param[in] ncomp number of components to expand
      */
-    void ExpandR2R (amrex::FArrayBox& dst, amrex::FArrayBox& src)
+    void ExpandR2R (amrex::FArrayBox& dst, amrex::FArrayBox& src, const int ncomp)
     {
         HIPACE_DETAIL_PROFILE("AnyDST::ExpandR2R()");
-        constexpr int scomp = 0;
-        constexpr int dcomp = 0;
 
         const amrex::Box bx = src.box();
         const int nx = bx.length(0);
@@ -31,17 +30,17 @@ namespace AnyDST
         amrex::Array4<amrex::Real> const & dst_array = dst.array();
 
         amrex::ParallelFor(
-            bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int)
+            bx, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int, int n)
             {
                 /* upper left quadrant */
-                dst_array(i+1,j+1,lo[2],dcomp) = src_array(i, j, lo[2], scomp);
+                dst_array(i+1,j+1,lo[2],n) = src_array(i, j, lo[2], n);
                 /* lower left quadrant */
-                dst_array(i+1,j+ny+2,lo[2],dcomp) = -src_array(i, ny-1-j+2*lo[1], lo[2], scomp);
+                dst_array(i+1,j+ny+2,lo[2],n) = -src_array(i, ny-1-j+2*lo[1], lo[2], n);
                 /* upper right quadrant */
-                dst_array(i+nx+2,j+1,lo[2],dcomp) = -src_array(nx-1-i+2*lo[0], j, lo[2], scomp);
+                dst_array(i+nx+2,j+1,lo[2],n) = -src_array(nx-1-i+2*lo[0], j, lo[2], n);
                 /* lower right quadrant */
-                dst_array(i+nx+2,j+ny+2,lo[2],dcomp) = src_array(nx-1-i+2*lo[0], ny-1-j+2*lo[1], lo[2], scomp);
+                dst_array(i+nx+2,j+ny+2,lo[2],n) = src_array(nx-1-i+2*lo[0], ny-1-j+2*lo[1], lo[2], n);
             }
             );
     };
@@ -50,22 +49,22 @@ namespace AnyDST
      *
      * \param[in,out] dst destination array
      * \param[in] src destination array, symmetric in x and y
+     * \param[in] ncomp number of components to shrink
      */
-    void ShrinkC2R (amrex::FArrayBox& dst, amrex::BaseFab<amrex::GpuComplex<amrex::Real>>& src)
+    void ShrinkC2R (amrex::FArrayBox& dst, amrex::BaseFab<amrex::GpuComplex<amrex::Real>>& src,
+                    const int ncomp)
     {
         HIPACE_DETAIL_PROFILE("AnyDST::ShrinkC2R()");
-        constexpr int scomp = 0;
-        constexpr int dcomp = 0;
 
         const amrex::Box bx = dst.box();
         amrex::Array4<amrex::GpuComplex<amrex::Real> const> const & src_array = src.array();
         amrex::Array4<amrex::Real> const & dst_array = dst.array();
         amrex::ParallelFor(
-            bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k)
+            bx, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n)
             {
                 /* upper left quadrant */
-                dst_array(i,j,k,dcomp) = -src_array(i+1, j+1, 0, scomp).real();
+                dst_array(i,j,k,n) = -src_array(i+1, j+1, 0, n).real();
             }
             );
     };
@@ -227,11 +226,16 @@ namespace AnyDST
     };
 
     DSTplan CreatePlan (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
-                        amrex::FArrayBox* fourier_array)
+                        amrex::FArrayBox* fourier_array, const int ncomp)
     {
         HIPACE_PROFILE("AnyDST::CreatePlan()");
         DSTplan dst_plan;
 
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+        dst_plan.m_ncomp = ncomp;
+
         amrex::ParmParse pp("hipace");
         dst_plan.use_small_dst = (std::max(real_size[0], real_size[1]) >= 511);
         queryWithParser(pp, "use_small_dst", dst_plan.use_small_dst);
@@ -255,10 +259,10 @@ namespace AnyDST
             expanded_fourier_box += fourier_array->box().smallEnd();
             dst_plan.m_expanded_position_array =
                 std::make_unique<amrex::FArrayBox>(
-                    expanded_position_box, 1);
+                    expanded_position_box, ncomp);
             dst_plan.m_expanded_fourier_array =
                 std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
-                    expanded_fourier_box, 1);
+                    expanded_fourier_box, ncomp);
 
             // setting the initial values to 0
             // we don't set the expanded Fourier array, because it will be initialized by the FFT
@@ -269,9 +273,14 @@ namespace AnyDST
             const amrex::IntVect& expanded_size = expanded_position_box.length();
 
             // Initialize fft_plan.m_plan with the vendor fft plan.
+            // All ncomp components are transformed in one batch
+            int n[2] = {expanded_size[1], expanded_size[0]};
+            const int position_dist = static_cast<int>(expanded_position_box.numPts());
+            const int fourier_dist = static_cast<int>(expanded_fourier_box.numPts());
             cufftResult result;
-            result = cufftPlan2d(
-                &(dst_plan.m_plan), expanded_size[1], expanded_size[0], VendorR2C);
+            result = cufftPlanMany(
+                &(dst_plan.m_plan), 2, n, NULL, 1, position_dist,
+                NULL, 1, fourier_dist, VendorR2C, ncomp);
 
             if ( result != CUFFT_SUCCESS ) {
                 amrex::Print() << " cufftplan failed! Error: " <<
@@ -303,16 +312,17 @@ namespace AnyDST
             amrex::Box complex_box {{0, 0, 0}, {complex_1d_size-1, 0, 0}};
             dst_plan.m_expanded_position_array =
                 std::make_unique<amrex::FArrayBox>(
-                    real_box, 1);
+                    real_box, ncomp);
             dst_plan.m_expanded_fourier_array =
                 std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
-                    complex_box, 1);
+                    complex_box, ncomp);
 
             // Initialize fft_plan.m_plan with the vendor fft plan.
             int s_1 = nx+1;
             cufftResult result;
             result = cufftPlanMany(
-                &(dst_plan.m_plan), 1, &s_1, NULL, 1, (nx+1)/2+1, NULL, 1, nx+1, VendorC2R, ny);
+                &(dst_plan.m_plan), 1, &s_1, NULL, 1, (nx+1)/2+1, NULL, 1, nx+1, VendorC2R,
+                ny*ncomp);
 
             if ( result != CUFFT_SUCCESS ) {
                 amrex::Print() << " cufftplan failed! Error: " <<
@@ -323,7 +333,8 @@ namespace AnyDST
             int s_2 = ny+1;
             cufftResult resultb;
             resultb = cufftPlanMany(
-                &(dst_plan.m_plan_b), 1, &s_2, NULL, 1, (ny+1)/2+1, NULL, 1, ny+1, VendorC2R, nx);
+                &(dst_plan.m_plan_b), 1, &s_2, NULL, 1, (ny+1)/2+1, NULL, 1, ny+1, VendorC2R,
+                nx*ncomp);
 
             if ( resultb != CUFFT_SUCCESS ) {
                 amrex::Print() << " cufftplan failed! Error: " <<
@@ -348,17 +359,95 @@ namespace AnyDST
         }
     }
 
+    DSTplan CreatePlan1D (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
+                          amrex::FArrayBox* fourier_array, const int ncomp)
+    {
+        HIPACE_PROFILE("AnyDST::CreatePlan1D()");
+        DSTplan dst_plan;
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+
+        // Same algorithm as the small DST, but only along x
+        const int n_data = real_size[0];
+        const int n_batch = real_size[1];
+
+        amrex::Box real_box {{0, 0, 0}, {(n_data+1)*n_batch-1, 0, 0}};
+        amrex::Box complex_box {{0, 0, 0}, {((n_data+1)/2+1)*n_batch-1, 0, 0}};
+        dst_plan.m_expanded_position_array =
+            std::make_unique<amrex::FArrayBox>(
+                real_box, ncomp);
+        dst_plan.m_expanded_fourier_array =
+            std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
+                complex_box, ncomp);
+
+        // Initialize fft_plan.m_plan with the vendor fft plan.
+        int s_1 = n_data+1;
+        cufftResult result;
+        result = cufftPlanMany(
+            &(dst_plan.m_plan), 1, &s_1, NULL, 1, (n_data+1)/2+1, NULL, 1, n_data+1, VendorC2R,
+            n_batch*ncomp);
+
+        if ( result != CUFFT_SUCCESS ) {
+            amrex::Print() << " cufftplan failed! Error: " <<
+                CuFFTUtils::cufftErrorToString(result) << "\n";
+        }
+        // m_plan_b is not used, but is destroyed in DestroyPlan
+        dst_plan.m_plan_b = dst_plan.m_plan;
+
+        // Store meta-data in dst_plan
+        dst_plan.m_position_array = position_array;
+        dst_plan.m_fourier_array = fourier_array;
+        dst_plan.m_ncomp = ncomp;
+        dst_plan.m_is_1d = true;
+        dst_plan.use_small_dst = true;
+
+        return dst_plan;
+    }
+
     void DestroyPlan (DSTplan& dst_plan)
     {
         cufftDestroy( dst_plan.m_plan );
-        cufftDestroy( dst_plan.m_plan_b );
+        if (!dst_plan.m_is_1d) cufftDestroy( dst_plan.m_plan_b );
+    }
+
+    /** \brief Perform a batch of 1D DSTs along x
+     *
+     * \param[in,out] dst_plan plan for which the DST is performed
+     */
+    template<direction d>
+    void Execute1D (DSTplan& dst_plan){
+        const int nx = dst_plan.m_position_array->box().length(0);
+        const int ny = dst_plan.m_position_array->box().length(1);
+        const int ncomp = dst_plan.m_ncomp;
+
+        amrex::Real* const tmp_pos_arr = dst_plan.m_position_array->dataPtr();
+        amrex::Real* const tmp_fourier_arr = dst_plan.m_fourier_array->dataPtr();
+        amrex::GpuComplex<amrex::Real>* comp_arr = dst_plan.m_expanded_fourier_array->dataPtr();
+        amrex::Real* const real_arr = dst_plan.m_expanded_position_array->dataPtr();
+
+        // Swap position and fourier space based on execute direction
+        amrex::Real* const pos_arr =
+            (d == direction::forward) ? tmp_pos_arr : tmp_fourier_arr;
+        amrex::Real* const fourier_arr =
+            (d == direction::forward) ? tmp_fourier_arr : tmp_pos_arr;
+
+        ToComplex(pos_arr, comp_arr, nx, ny*ncomp);
+
+        C2Rfft(dst_plan.m_plan, comp_arr, real_arr);
+
+        ToSine(real_arr, fourier_arr, nx, ny*ncomp);
     }
 
     template<direction d>
     void Execute (DSTplan& dst_plan){
         HIPACE_PROFILE("AnyDST::Execute()");
 
-        if(!dst_plan.use_small_dst) {
+        if (dst_plan.m_is_1d) {
+            Execute1D<d>(dst_plan);
+        }
+        else if(!dst_plan.use_small_dst) {
             // Swap position and fourier space based on execute direction
             amrex::FArrayBox* position_array =
                 (d == direction::forward) ? dst_plan.m_position_array : dst_plan.m_fourier_array;
@@ -366,7 +455,7 @@ namespace AnyDST
                 (d == direction::forward) ? dst_plan.m_fourier_array : dst_plan.m_position_array;
 
             // Expand in position space m_position_array -> m_expanded_position_array
-            ExpandR2R(*dst_plan.m_expanded_position_array, *position_array);
+            ExpandR2R(*dst_plan.m_expanded_position_array, *position_array, dst_plan.m_ncomp);
 
             cudaStream_t stream = amrex::Gpu::Device::cudaStream();
             cufftSetStream ( dst_plan.m_plan, stream);
@@ -383,7 +472,7 @@ namespace AnyDST
                 reinterpret_cast<AnyFFT::Complex*>(dst_plan.m_expanded_fourier_array->dataPtr()));
 #endif
             // Shrink in Fourier space m_expanded_fourier_array -> m_fourier_array
-            ShrinkC2R(*fourier_array, *dst_plan.m_expanded_fourier_array);
+            ShrinkC2R(*fourier_array, *dst_plan.m_expanded_fourier_array, dst_plan.m_ncomp);
 
             if ( result != CUFFT_SUCCESS ) {
                 amrex::Print() << " forward transform using cufftExec failed ! Error: " <<
@@ -405,21 +494,30 @@ namespace AnyDST
             amrex::Real* const fourier_arr =
                 (d == direction::forward) ? tmp_fourier_arr : tmp_pos_arr;
 
-            ToComplex(pos_arr, comp_arr, nx, ny);
+            // The components are stored one after the other, so the columns of all components
+            // can be transformed as one batch. Only the transpose is done per component.
+            const int ncomp = dst_plan.m_ncomp;
+            const int comp_stride = nx*ny;
+
+            ToComplex(pos_arr, comp_arr, nx, ny*ncomp);
 
             C2Rfft(dst_plan.m_plan, comp_arr, real_arr);
 
-            ToSine(real_arr, pos_arr, nx, ny);
+            ToSine(real_arr, pos_arr, nx, ny*ncomp);
 
-            Transpose(pos_arr, fourier_arr, nx, ny);
+            for (int n=0; n<ncomp; ++n) {
+                Transpose(pos_arr+n*comp_stride, fourier_arr+n*comp_stride, nx, ny);
+            }
 
-            ToComplex(fourier_arr, comp_arr, ny, nx);
+            ToComplex(fourier_arr, comp_arr, ny, nx*ncomp);
 
             C2Rfft(dst_plan.m_plan_b, comp_arr, real_arr);
 
-            ToSine(real_arr, pos_arr, ny, nx);
+            ToSine(real_arr, pos_arr, ny, nx*ncomp);
 
-            Transpose(pos_arr, fourier_arr, ny, nx);
+            for (int n=0; n<ncomp; ++n) {
+                Transpose(pos_arr+n*comp_stride, fourier_arr+n*comp_stride, ny, nx);
+            }
         }
     }
 
@@ -20,7 +20,7 @@ namespace AnyFFT
 #endif
 
     FFTplan CreatePlan (const amrex::IntVect& real_size, amrex::Real * const real_array,
-                        Complex * const complex_array, const direction dir)
+                        Complex * const complex_array, const direction dir, const int ncomp)
     {
         FFTplan fft_plan;
 
@@ -30,14 +30,20 @@ namespace AnyFFT
             "version >= 11.2 (recommended) or <= 11.0 for larger grid sizes.");
         }
 
+        // Swap dimensions: AMReX FAB are Fortran-order but cuFFT is C-order
+        int n[2] = {real_size[1], real_size[0]};
+        // Distance between two consecutive components in real and spectral space
+        const int real_dist = real_size[0]*real_size[1];
+        const int complex_dist = (real_size[0]/2+1)*real_size[1];
+
         // Initialize fft_plan.m_plan with the vendor fft plan.
         cufftResult result;
         if (dir == direction::R2C){
-            result = cufftPlan2d(
-                &(fft_plan.m_plan), real_size[1], real_size[0], VendorR2C);
+            result = cufftPlanMany(&(fft_plan.m_plan), 2, n, NULL, 1, real_dist,
+                                   NULL, 1, complex_dist, VendorR2C, ncomp);
         } else {
-            result = cufftPlan2d(
-                &(fft_plan.m_plan), real_size[1], real_size[0], VendorC2R);
+            result = cufftPlanMany(&(fft_plan.m_plan), 2, n, NULL, 1, complex_dist,
+                                   NULL, 1, real_dist, VendorC2R, ncomp);
         }
 
         if ( result != CUFFT_SUCCESS ) {
@@ -53,6 +59,13 @@ namespace AnyFFT
         return fft_plan;
     }
 
+    void PlanWithWisdom (const amrex::IntVect& /*real_size*/, MPI_Comm /*comm*/,
+                         const std::function<void()>& create_plans)
+    {
+        // Plans are not measured, there is nothing to share
+        create_plans();
+    }
+
     void DestroyPlan (FFTplan& fft_plan)
     {
         cufftDestroy( fft_plan.m_plan );
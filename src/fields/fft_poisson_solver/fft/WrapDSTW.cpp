@@ -1,54 +1,104 @@
 #include "AnyDST.H"
+#include "FFTWUtils.H"
 #include "utils/HipaceProfilerWrapper.H"
 
-#ifdef AMREX_USE_OMP
-#   include <omp.h>
-#endif
-
 namespace AnyDST
 {
 #ifdef AMREX_USE_FLOAT
-    const auto VendorCreatePlanR2R2D = fftwf_plan_r2r_2d;
+    const auto VendorCreatePlanManyR2R = fftwf_plan_many_r2r;
+    const auto VendorCreatePlanGuruR2R = fftwf_plan_guru_r2r;
 #else
-    const auto VendorCreatePlanR2R2D = fftw_plan_r2r_2d;
+    const auto VendorCreatePlanManyR2R = fftw_plan_many_r2r;
+    const auto VendorCreatePlanGuruR2R = fftw_plan_guru_r2r;
 #endif
 
     DSTplan CreatePlan (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
-                        amrex::FArrayBox* fourier_array)
+                        amrex::FArrayBox* fourier_array, const int ncomp)
     {
         DSTplan dst_plan;
         const int nx = real_size[0];
         const int ny = real_size[1];
 
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+
 #if defined(AMREX_USE_OMP) && defined(HIPACE_FFTW_OMP)
-        if (nx > 32 && ny > 32) {
+        const int nthreads = FFTWUtils::NumThreads(real_size);
+        if (nthreads > 1) {
 #   ifdef AMREX_USE_FLOAT
             fftwf_init_threads();
-            fftwf_plan_with_nthreads(omp_get_max_threads());
+            fftwf_plan_with_nthreads(nthreads);
 #   else
             fftw_init_threads();
-            fftw_plan_with_nthreads(omp_get_max_threads());
+            fftw_plan_with_nthreads(nthreads);
 #   endif
         }
 #endif
 
-        // Initialize fft_plan.m_plan with the vendor fft plan.
         // Swap dimensions: AMReX FAB are Fortran-order but FFTW is C-order
-        dst_plan.m_plan = VendorCreatePlanR2R2D(
-            ny, nx, position_array->dataPtr(), fourier_array->dataPtr(),
-            FFTW_RODFT00, FFTW_RODFT00, FFTW_ESTIMATE);
+        const int n[2] = {ny, nx};
+        const fftw_r2r_kind kinds[2] = {FFTW_RODFT00, FFTW_RODFT00};
+        // The ncomp components of a FAB are stored one after the other
+        const int dist = nx*ny;
+
+        const unsigned flag = FFTWUtils::PlannerFlag();
+
+        // Initialize fft_plan.m_plan with the vendor fft plan.
+        dst_plan.m_plan = VendorCreatePlanManyR2R(
+            2, n, ncomp, position_array->dataPtr(), nullptr, 1, dist,
+            fourier_array->dataPtr(), nullptr, 1, dist, kinds, flag);
 
         // Initialize fft_plan.m_plan_b with the vendor fft plan.
         // Swap arrays: now for backward direction.
-        dst_plan.m_plan_b = VendorCreatePlanR2R2D(
-            ny, nx, fourier_array->dataPtr(), position_array->dataPtr(),
-            FFTW_RODFT00, FFTW_RODFT00, FFTW_ESTIMATE);
+        dst_plan.m_plan_b = VendorCreatePlanManyR2R(
+            2, n, ncomp, fourier_array->dataPtr(), nullptr, 1, dist,
+            position_array->dataPtr(), nullptr, 1, dist, kinds, flag);
+
+        amrex::Print() << "using R2R FFTW of size " << nx << " * " << ny << " with "
+            << ncomp << " batched component(s)\n";
+
+        // Store meta-data in fft_plan
+        dst_plan.m_position_array = position_array;
+        dst_plan.m_fourier_array = fourier_array;
+        dst_plan.m_ncomp = ncomp;
+
+        return dst_plan;
+    }
+
+    DSTplan CreatePlan1D (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
+                          amrex::FArrayBox* fourier_array, const int ncomp)
+    {
+        DSTplan dst_plan;
+        const int nx = real_size[0];
+        const int ny = real_size[1];
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+
+        // Transform along x, batch over y and over the components.
+        // Strides are in units of Real, AMReX FAB are Fortran-order.
+        const fftw_iodim dims[1] = {fftw_iodim{nx, 1, 1}};
+        const fftw_iodim howmany_dims[2] = {
+            fftw_iodim{ny, nx, nx},
+            fftw_iodim{ncomp, nx*ny, nx*ny}};
+        const fftw_r2r_kind kinds[1] = {FFTW_RODFT00};
+
+        const unsigned flag = FFTWUtils::PlannerFlag();
 
-        amrex::Print() << "using R2R FFTW of size " << nx << " * " << ny << "\n";
+        dst_plan.m_plan = VendorCreatePlanGuruR2R(
+            1, dims, 2, howmany_dims, position_array->dataPtr(), fourier_array->dataPtr(),
+            kinds, flag);
+        dst_plan.m_plan_b = VendorCreatePlanGuruR2R(
+            1, dims, 2, howmany_dims, fourier_array->dataPtr(), position_array->dataPtr(),
+            kinds, flag);
 
         // Store meta-data in fft_plan
         dst_plan.m_position_array = position_array;
         dst_plan.m_fourier_array = fourier_array;
+        dst_plan.m_ncomp = ncomp;
+        dst_plan.m_is_1d = true;
 
         return dst_plan;
     }
@@ -5,35 +5,41 @@
  * License: BSD-3-Clause-LBNL
  */
 #include "AnyFFT.H"
+#include "FFTWUtils.H"
 #include "utils/HipaceProfilerWrapper.H"
 
 namespace AnyFFT
 {
 #ifdef AMREX_USE_FLOAT
-    const auto VendorCreatePlanR2C3D = fftwf_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftwf_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftwf_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftwf_plan_dft_c2r_2d;
+    const auto VendorCreatePlanManyR2C = fftwf_plan_many_dft_r2c;
+    const auto VendorCreatePlanManyC2R = fftwf_plan_many_dft_c2r;
 #else
-    const auto VendorCreatePlanR2C3D = fftw_plan_dft_r2c_3d;
-    const auto VendorCreatePlanC2R3D = fftw_plan_dft_c2r_3d;
-    const auto VendorCreatePlanR2C2D = fftw_plan_dft_r2c_2d;
-    const auto VendorCreatePlanC2R2D = fftw_plan_dft_c2r_2d;
+    const auto VendorCreatePlanManyR2C = fftw_plan_many_dft_r2c;
+    const auto VendorCreatePlanManyC2R = fftw_plan_many_dft_c2r;
 #endif
 
     FFTplan CreatePlan (const amrex::IntVect& real_size, amrex::Real * const real_array,
-                        Complex * const complex_array, const direction dir)
+                        Complex * const complex_array, const direction dir, const int ncomp)
     {
         FFTplan fft_plan;
 
-        // Initialize fft_plan.m_plan with the vendor fft plan.
         // Swap dimensions: AMReX FAB are Fortran-order but FFTW is C-order
+        const int n[2] = {real_size[1], real_size[0]};
+        // Distance between two consecutive components in real and spectral space
+        const int real_dist = real_size[0]*real_size[1];
+        const int complex_dist = (real_size[0]/2+1)*real_size[1];
+
+        const unsigned flag = FFTWUtils::PlannerFlag();
+
+        // Initialize fft_plan.m_plan with the vendor fft plan.
         if (dir == direction::R2C){
-            fft_plan.m_plan = VendorCreatePlanR2C2D(
-                    real_size[1], real_size[0], real_array, complex_array, FFTW_ESTIMATE);
+            fft_plan.m_plan = VendorCreatePlanManyR2C(
+                    2, n, ncomp, real_array, nullptr, 1, real_dist,
+                    complex_array, nullptr, 1, complex_dist, flag);
         } else if (dir == direction::C2R){
-            fft_plan.m_plan = VendorCreatePlanC2R2D(
-                    real_size[1], real_size[0], complex_array, real_array, FFTW_ESTIMATE);
+            fft_plan.m_plan = VendorCreatePlanManyC2R(
+                    2, n, ncomp, complex_array, nullptr, 1, complex_dist,
+                    real_array, nullptr, 1, real_dist, flag);
         }
 
         // Store meta-data in fft_plan
@@ -44,6 +50,12 @@ namespace AnyFFT
         return fft_plan;
     }
 
+    void PlanWithWisdom (const amrex::IntVect& real_size, MPI_Comm comm,
+                         const std::function<void()>& create_plans)
+    {
+        FFTWUtils::PlanWithWisdom(real_size, comm, create_plans);
+    }
+
     void DestroyPlan (FFTplan& fft_plan)
     {
 #  ifdef AMREX_USE_FLOAT
@@ -11,12 +11,11 @@ namespace AnyDST
      *
      * \param[in,out] dst destination array, odd symmetry around 0 and the middle points in x and y
      * \param[in] src source array
+     * \param[in] ncomp number of components to expand
      */
-    void ExpandR2R (amrex::FArrayBox& dst, amrex::FArrayBox& src)
+    void ExpandR2R (amrex::FArrayBox& dst, amrex::FArrayBox& src, const int ncomp)
     {
         HIPACE_DETAIL_PROFILE("AnyDST::ExpandR2R()");
-        constexpr int scomp = 0;
-        constexpr int dcomp = 0;
 
         const amrex::Box bx = src.box();
         const int nx = bx.length(0);
@@ -26,17 +25,17 @@ namespace AnyDST
         amrex::Array4<amrex::Real> const & dst_array = dst.array();
 
         amrex::ParallelFor(
-            bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int)
+            bx, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int, int n)
             {
                 /* upper left quadrant */
-                dst_array(i+1,j+1,lo[2],dcomp) = src_array(i, j, lo[2], scomp);
+                dst_array(i+1,j+1,lo[2],n) = src_array(i, j, lo[2], n);
                 /* lower left quadrant */
-                dst_array(i+1,j+ny+2,lo[2],dcomp) = -src_array(i, ny-1-j+2*lo[1], lo[2], scomp);
+                dst_array(i+1,j+ny+2,lo[2],n) = -src_array(i, ny-1-j+2*lo[1], lo[2], n);
                 /* upper right quadrant */
-                dst_array(i+nx+2,j+1,lo[2],dcomp) = -src_array(nx-1-i+2*lo[0], j, lo[2], scomp);
+                dst_array(i+nx+2,j+1,lo[2],n) = -src_array(nx-1-i+2*lo[0], j, lo[2], n);
                 /* lower right quadrant */
-                dst_array(i+nx+2,j+ny+2,lo[2],dcomp) = src_array(nx-1-i+2*lo[0], ny-1-j+2*lo[1], lo[2], scomp);
+                dst_array(i+nx+2,j+ny+2,lo[2],n) = src_array(nx-1-i+2*lo[0], ny-1-j+2*lo[1], lo[2], n);
             }
             );
     }
@@ -45,22 +44,22 @@ namespace AnyDST
      *
      * \param[in,out] dst destination array
      * \param[in] src destination array, symmetric in x and y
+     * \param[in] ncomp number of components to shrink
      */
-    void ShrinkC2R (amrex::FArrayBox& dst, amrex::BaseFab<amrex::GpuComplex<amrex::Real>>& src)
+    void ShrinkC2R (amrex::FArrayBox& dst, amrex::BaseFab<amrex::GpuComplex<amrex::Real>>& src,
+                    const int ncomp)
     {
         HIPACE_DETAIL_PROFILE("AnyDST::ShrinkC2R()");
-        constexpr int scomp = 0;
-        constexpr int dcomp = 0;
 
         const amrex::Box bx = dst.box();
         amrex::Array4<amrex::GpuComplex<amrex::Real> const> const & src_array = src.array();
         amrex::Array4<amrex::Real> const & dst_array = dst.array();
         amrex::ParallelFor(
-            bx,
-            [=] AMREX_GPU_DEVICE(int i, int j, int k)
+            bx, ncomp,
+            [=] AMREX_GPU_DEVICE(int i, int j, int k, int n)
             {
                 /* upper left quadrant */
-                dst_array(i,j,k,dcomp) = -src_array(i+1, j+1, 0, scomp).real();
+                dst_array(i,j,k,n) = -src_array(i+1, j+1, 0, n).real();
             }
             );
     }
@@ -217,11 +216,16 @@ namespace AnyDST
     }
 
     DSTplan CreatePlan (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
-                        amrex::FArrayBox* fourier_array)
+                        amrex::FArrayBox* fourier_array, const int ncomp)
     {
         HIPACE_PROFILE("AnyDST::CreatePlan()");
         DSTplan dst_plan;
 
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+        dst_plan.m_ncomp = ncomp;
+
         amrex::ParmParse pp("hipace");
         dst_plan.use_small_dst = (std::max(real_size[0], real_size[1]) >= 511);
         queryWithParser(pp, "use_small_dst", dst_plan.use_small_dst);
@@ -240,10 +244,10 @@ namespace AnyDST
             expanded_fourier_box += fourier_array->box().smallEnd();
             dst_plan.m_expanded_position_array =
                 std::make_unique<amrex::FArrayBox>(
-                    expanded_position_box, 1);
+                    expanded_position_box, ncomp);
             dst_plan.m_expanded_fourier_array =
                 std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
-                    expanded_fourier_box, 1);
+                    expanded_fourier_box, ncomp);
 
             // setting the initial values to 0
             // we don't set the expanded Fourier array, because it will be initialized by the FFT
@@ -271,7 +275,7 @@ namespace AnyDST
                                         precision,
                                         dim,
                                         lengths,
-                                        1,
+                                        ncomp,
                                         nullptr);
 
             RocFFTUtils::assert_rocfft_status("rocfft_plan_create", result);
@@ -313,10 +317,10 @@ namespace AnyDST
             amrex::Box complex_box {{0, 0, 0}, {complex_1d_size-1, 0, 0}};
             dst_plan.m_expanded_position_array =
                 std::make_unique<amrex::FArrayBox>(
-                    real_box, 1);
+                    real_box, ncomp);
             dst_plan.m_expanded_fourier_array =
                 std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
-                    complex_box, 1);
+                    complex_box, ncomp);
 
 #ifdef AMREX_USE_FLOAT
             rocfft_precision precision = rocfft_precision_single;
@@ -334,7 +338,7 @@ namespace AnyDST
                                         precision,
                                         1,
                                         s_1,
-                                        ny,
+                                        ny*ncomp,
                                         nullptr);
 
             RocFFTUtils::assert_rocfft_status("rocfft_plan_create", result);
@@ -347,7 +351,7 @@ namespace AnyDST
                                         precision,
                                         1,
                                         s_2,
-                                        nx,
+                                        nx*ncomp,
                                         nullptr);
 
             RocFFTUtils::assert_rocfft_status("rocfft_plan_create", result);
@@ -387,20 +391,119 @@ namespace AnyDST
         }
     }
 
+    DSTplan CreatePlan1D (const amrex::IntVect& real_size, amrex::FArrayBox* position_array,
+                          amrex::FArrayBox* fourier_array, const int ncomp)
+    {
+        HIPACE_PROFILE("AnyDST::CreatePlan1D()");
+        DSTplan dst_plan;
+
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(
+            position_array->nComp() >= ncomp && fourier_array->nComp() >= ncomp,
+            "Not enough components in the arrays for the batched DST");
+
+        // Same algorithm as the small DST, but only along x
+        const int n_data = real_size[0];
+        const int n_batch = real_size[1];
+
+        amrex::Box real_box {{0, 0, 0}, {(n_data+1)*n_batch-1, 0, 0}};
+        amrex::Box complex_box {{0, 0, 0}, {((n_data+1)/2+1)*n_batch-1, 0, 0}};
+        dst_plan.m_expanded_position_array =
+            std::make_unique<amrex::FArrayBox>(
+                real_box, ncomp);
+        dst_plan.m_expanded_fourier_array =
+            std::make_unique<amrex::BaseFab<amrex::GpuComplex<amrex::Real>>>(
+                complex_box, ncomp);
+
+#ifdef AMREX_USE_FLOAT
+        rocfft_precision precision = rocfft_precision_single;
+#else
+        rocfft_precision precision = rocfft_precision_double;
+#endif
+
+        rocfft_status result;
+        const std::size_t s_1[3] = {std::size_t(n_data+1) ,0u ,0u};
+        result = rocfft_plan_create(&(dst_plan.m_plan),
+                                    rocfft_placement_notinplace,
+                                    rocfft_transform_type_real_inverse,
+                                    precision,
+                                    1,
+                                    s_1,
+                                    n_batch*ncomp,
+                                    nullptr);
+        RocFFTUtils::assert_rocfft_status("rocfft_plan_create", result);
+        // m_plan_b is not used, but is destroyed in DestroyPlan
+        dst_plan.m_plan_b = nullptr;
+
+        std::size_t buffersize = 0;
+        result = rocfft_plan_get_work_buffer_size(dst_plan.m_plan, &buffersize);
+        RocFFTUtils::assert_rocfft_status("rocfft_plan_get_work_buffer_size", result);
+
+        result = rocfft_execution_info_create(&(dst_plan.m_execinfo));
+        RocFFTUtils::assert_rocfft_status("rocfft_execution_info_create", result);
+
+        dst_plan.m_buffer = amrex::The_Arena()->alloc(buffersize);
+        result = rocfft_execution_info_set_work_buffer(dst_plan.m_execinfo, dst_plan.m_buffer,
+                                                       buffersize);
+        RocFFTUtils::assert_rocfft_status("rocfft_execution_info_set_work_buffer", result);
+
+        result = rocfft_execution_info_set_stream(dst_plan.m_execinfo, amrex::Gpu::gpuStream());
+        RocFFTUtils::assert_rocfft_status("rocfft_execution_info_set_stream", result);
+
+        // Store meta-data in dst_plan
+        dst_plan.m_position_array = position_array;
+        dst_plan.m_fourier_array = fourier_array;
+        dst_plan.m_ncomp = ncomp;
+        dst_plan.m_is_1d = true;
+        dst_plan.use_small_dst = true;
+
+        return dst_plan;
+    }
+
     void DestroyPlan (DSTplan& dst_plan)
     {
         rocfft_plan_destroy( dst_plan.m_plan );
-        rocfft_plan_destroy( dst_plan.m_plan_b );
+        if (!dst_plan.m_is_1d) rocfft_plan_destroy( dst_plan.m_plan_b );
 
         amrex::The_Arena()->free(dst_plan.m_buffer);
         rocfft_execution_info_destroy(dst_plan.m_execinfo);
     }
 
+    /** \brief Perform a batch of 1D DSTs along x
+     *
+     * \param[in,out] dst_plan plan for which the DST is performed
+     */
+    template<direction d>
+    void Execute1D (DSTplan& dst_plan){
+        const int nx = dst_plan.m_position_array->box().length(0);
+        const int ny = dst_plan.m_position_array->box().length(1);
+        const int ncomp = dst_plan.m_ncomp;
+
+        amrex::Real* const tmp_pos_arr = dst_plan.m_position_array->dataPtr();
+        amrex::Real* const tmp_fourier_arr = dst_plan.m_fourier_array->dataPtr();
+        amrex::GpuComplex<amrex::Real>* comp_arr = dst_plan.m_expanded_fourier_array->dataPtr();
+        amrex::Real* const real_arr = dst_plan.m_expanded_position_array->dataPtr();
+
+        // Swap position and fourier space based on execute direction
+        amrex::Real* const pos_arr =
+            (d == direction::forward) ? tmp_pos_arr : tmp_fourier_arr;
+        amrex::Real* const fourier_arr =
+            (d == direction::forward) ? tmp_fourier_arr : tmp_pos_arr;
+
+        ToComplex(pos_arr, comp_arr, nx, ny*ncomp);
+
+        C2Rfft(dst_plan.m_plan, comp_arr, real_arr, dst_plan.m_execinfo);
+
+        ToSine(real_arr, fourier_arr, nx, ny*ncomp);
+    }
+
     template<direction d>
     void Execute (DSTplan& dst_plan){
         HIPACE_PROFILE("AnyDST::Execute()");
 
-        if(!dst_plan.use_small_dst) {
+        if (dst_plan.m_is_1d) {
+            Execute1D<d>(dst_plan);
+        }
+        else if(!dst_plan.use_small_dst) {
             // Swap position and fourier space based on execute direction
             amrex::FArrayBox* position_array =
                 (d == direction::forward) ? dst_plan.m_position_array : dst_plan.m_fourier_array;
@@ -408,7 +511,7 @@ namespace AnyDST
                 (d == direction::forward) ? dst_plan.m_fourier_array : dst_plan.m_position_array;
 
             // Expand in position space m_position_array -> m_expanded_position_array
-            ExpandR2R(*dst_plan.m_expanded_position_array, *position_array);
+            ExpandR2R(*dst_plan.m_expanded_position_array, *position_array, dst_plan.m_ncomp);
 
             rocfft_status result;
 
@@ -420,7 +523,7 @@ namespace AnyDST
             RocFFTUtils::assert_rocfft_status("rocfft_execute", result);
 
             // Shrink in Fourier space m_expanded_fourier_array -> m_fourier_array
-            ShrinkC2R(*fourier_array, *dst_plan.m_expanded_fourier_array);
+            ShrinkC2R(*fourier_array, *dst_plan.m_expanded_fourier_array, dst_plan.m_ncomp);
         }
         else {
             const int nx = dst_plan.m_position_array->box().length(0); // initially contiguous
@@ -437,21 +540,30 @@ namespace AnyDST
             amrex::Real* const fourier_arr =
                 (d == direction::forward) ? tmp_fourier_arr : tmp_pos_arr;
 
-            ToComplex(pos_arr, comp_arr, nx, ny);
+            // The components are stored one after the other, so the columns of all components
+            // can be transformed as one batch. Only the transpose is done per component.
+            const int ncomp = dst_plan.m_ncomp;
+            const int comp_stride = nx*ny;
+
+            ToComplex(pos_arr, comp_arr, nx, ny*ncomp);
 
             C2Rfft(dst_plan.m_plan, comp_arr, real_arr, dst_plan.m_execinfo);
 
-            ToSine(real_arr, pos_arr, nx, ny);
+            ToSine(real_arr, pos_arr, nx, ny*ncomp);
 
-            Transpose(pos_arr, fourier_arr, nx, ny);
+            for (int n=0; n<ncomp; ++n) {
+                Transpose(pos_arr+n*comp_stride, fourier_arr+n*comp_stride, nx, ny);
+            }
 
-            ToComplex(fourier_arr, comp_arr, ny, nx);
+            ToComplex(fourier_arr, comp_arr, ny, nx*ncomp);
 
             C2Rfft(dst_plan.m_plan_b, comp_arr, real_arr, dst_plan.m_execinfo);
 
-            ToSine(real_arr, pos_arr, ny, nx);
+            ToSine(real_arr, pos_arr, ny, nx*ncomp);
 
-            Transpose(pos_arr, fourier_arr, ny, nx);
+            for (int n=0; n<ncomp; ++n) {
+                Transpose(pos_arr+n*comp_stride, fourier_arr+n*comp_stride, ny, nx);
+            }
         }
     }
 
@@ -11,7 +11,7 @@
 namespace AnyFFT
 {
     FFTplan CreatePlan (const amrex::IntVect& real_size, amrex::Real * const real_array,
-                        Complex * const complex_array, const direction dir)
+                        Complex * const complex_array, const direction dir, const int ncomp)
     {
         const int dim = 2;
         FFTplan fft_plan;
@@ -31,7 +31,7 @@ namespace AnyFFT
                                                   rocfft_precision_double,
 #endif
                                                   dim, lengths,
-                                                  1, // number of transforms,
+                                                  ncomp, // number of transforms,
                                                   nullptr);
         RocFFTUtils::assert_rocfft_status("rocfft_plan_create", result);
 
@@ -44,6 +44,13 @@ namespace AnyFFT
         return fft_plan;
     }
 
+    void PlanWithWisdom (const amrex::IntVect& /*real_size*/, MPI_Comm /*comm*/,
+                         const std::function<void()>& create_plans)
+    {
+        // Plans are not measured, there is nothing to share
+        create_plans();
+    }
+
     void DestroyPlan (FFTplan& fft_plan)
     {
         rocfft_plan_destroy( fft_plan.m_plan );
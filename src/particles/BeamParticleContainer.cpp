@@ -46,8 +46,11 @@ BeamParticleContainer::ReadParameters ()
     queryWithParser(pp, "duz_per_uz0_dzeta", m_duz_per_uz0_dzeta);
     queryWithParser(pp, "do_z_push", m_do_z_push);
     queryWithParser(pp, "n_subcycles", m_n_subcycles);
+    queryWithParser(pp, "adaptive_subcycling", m_adaptive_subcycling);
+    queryWithParser(pp, "nt_per_betatron", m_nt_per_betatron);
     queryWithParser(pp, "finest_level", m_finest_level);
     AMREX_ALWAYS_ASSERT_WITH_MESSAGE( m_n_subcycles >= 1, "n_subcycles must be >= 1");
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE( m_nt_per_betatron > 0., "nt_per_betatron must be > 0");
     if (m_injection_type == "fixed_ppc" || m_injection_type == "from_file"){
         AMREX_ALWAYS_ASSERT_WITH_MESSAGE( (m_dx_per_dzeta == 0.) && (m_dy_per_dzeta == 0.)
                                            && (m_duz_per_uz0_dzeta == 0.),
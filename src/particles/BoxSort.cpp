@@ -1,10 +1,14 @@
 #include "BoxSort.H"
+#include "utils/HipaceProfilerWrapper.H"
 
 #include <AMReX_ParticleTransformation.H>
 
 void BoxSorter::sortParticlesByBox (BeamParticleContainer& a_beam,
-                                    const amrex::BoxArray a_ba, const amrex::Geometry& a_geom)
+                                    const amrex::BoxArray a_ba, const amrex::Geometry& a_geom,
+                                    const bool sort_by_slice)
 {
+    HIPACE_PROFILE("BoxSorter::sortParticlesByBox()");
+
     if (! m_particle_locator.isValid(a_ba)) m_particle_locator.build(a_ba, a_geom);
     auto assign_grid = m_particle_locator.getGridAssignor();
 
@@ -14,45 +18,144 @@ void BoxSorter::sortParticlesByBox (BeamParticleContainer& a_beam,
     constexpr unsigned int max_unsigned_int = std::numeric_limits<unsigned int>::max();
 
     int num_boxes = a_ba.size();
-    m_box_counts.resize(0);
-    m_box_offsets.resize(0);
-    m_box_counts.resize(num_boxes+1, 0);
-    m_box_offsets.resize(num_boxes+1);
 
-    amrex::Gpu::DeviceVector<unsigned int> dst_indices(np);
+    // Particles are sorted by key. Without sort_by_slice, the key is the box index. With it,
+    // each box has one key per slice, so the particles of a box are also sorted by slice.
+    // Particles that left the domain get the last key, after all boxes.
+    amrex::Vector<index_type> h_first_key(num_boxes+1, 0);
+    amrex::Vector<int> h_box_lo_z(num_boxes, 0);
+    for (int ibox = 0; ibox < num_boxes; ++ibox) {
+        h_first_key[ibox+1] = h_first_key[ibox] + (sort_by_slice ? a_ba[ibox].length(2) : 1);
+        h_box_lo_z[ibox] = a_ba[ibox].smallEnd(2);
+    }
+    const int num_keys = h_first_key[num_boxes] + 1;
+    m_first_key.resize(num_boxes+1);
+    m_box_lo_z.resize(num_boxes);
+    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h_first_key.begin(), h_first_key.end(),
+                          m_first_key.begin());
+    amrex::Gpu::copyAsync(amrex::Gpu::hostToDevice, h_box_lo_z.begin(), h_box_lo_z.end(),
+                          m_box_lo_z.begin());
 
-    auto p_box_counts = m_box_counts.dataPtr();
-    auto p_dst_indices = dst_indices.dataPtr();
+    m_key_counts.resize(0);
+    m_key_counts.resize(num_keys, 0);
+    m_key_offsets.resize(num_keys);
+    m_keys.resize(np);
+
+    // Slice index, computed as in findParticlesInEachSlice on level 0
+    const auto dxi = a_geom.InvCellSizeArray();
+    const auto plo = a_geom.ProbLoArray();
+
+    auto p_first_key = m_first_key.dataPtr();
+    auto p_box_lo_z = m_box_lo_z.dataPtr();
+    auto p_key_counts = m_key_counts.dataPtr();
+    auto p_keys = m_keys.dataPtr();
     AMREX_FOR_1D ( np, i,
     {
         int dst_box = assign_grid(particle_ptr[i]);
+        index_type key = 0;
         if (dst_box < 0) {
             // particle has left domain transversely, stick it at the end and invalidate
-            dst_box = num_boxes;
+            key = p_first_key[num_boxes];
             particle_ptr[i].id() = -std::abs(particle_ptr[i].id());
+        } else if (sort_by_slice) {
+            const int nslices = p_first_key[dst_box+1] - p_first_key[dst_box];
+            const int islice = static_cast<int>(
+                (particle_ptr[i].pos(2)-plo[2])*dxi[2]-p_box_lo_z[dst_box]);
+            key = p_first_key[dst_box] + amrex::min(amrex::max(islice, 0), nslices-1);
+        } else {
+            key = dst_box;
         }
-        unsigned int index = amrex::Gpu::Atomic::Inc(
-            &p_box_counts[dst_box], max_unsigned_int);
-        p_dst_indices[i] = index;
+        p_keys[i] = key;
+        amrex::Gpu::Atomic::Inc(&p_key_counts[key], max_unsigned_int);
     });
 
-    amrex::Gpu::exclusive_scan(m_box_counts.begin(), m_box_counts.end(), m_box_offsets.begin());
+    amrex::Gpu::exclusive_scan(m_key_counts.begin(), m_key_counts.end(), m_key_offsets.begin());
+
+    // Between two sorts, most particles stay in their box (and slice): only the particles that
+    // were pushed out of it, and the particles received or added at the end of the array, need
+    // to move. The particles [0, nkeep) are already at their sorted position: they are before the
+    // first decrease of the key, and their key is not larger than any key after them.
+    int nkeep = np;
+    if (np > 1) {
+        amrex::ReduceOps<amrex::ReduceOpMin> reduce_op;
+        amrex::ReduceData<int> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        reduce_op.eval(np, reduce_data,
+                       [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+                       {
+                           return (i > 0 && p_keys[i] < p_keys[i-1]) ? i : np;
+                       });
+        nkeep = amrex::min(amrex::get<0>(reduce_data.value()), np);
+    }
+    if (nkeep < np) {
+        amrex::ReduceOps<amrex::ReduceOpMin> reduce_op;
+        amrex::ReduceData<index_type> reduce_data(reduce_op);
+        using ReduceTuple = typename decltype(reduce_data)::Type;
+        const int first_unsorted = nkeep;
+        reduce_op.eval(np - first_unsorted, reduce_data,
+                       [=] AMREX_GPU_DEVICE (int i) -> ReduceTuple
+                       {
+                           return p_keys[first_unsorted+i];
+                       });
+        const index_type min_key = amrex::get<0>(reduce_data.value());
 
-    amrex::ParticleTile<0, 0, BeamIdx::nattribs, 0> tmp{};
-    tmp.resize(np);
+        amrex::ReduceOps<amrex::ReduceOpSum> reduce_op_sum;
+        amrex::ReduceData<int> reduce_data_sum(reduce_op_sum);
+        using ReduceTupleSum = typename decltype(reduce_data_sum)::Type;
+        reduce_op_sum.eval(first_unsorted, reduce_data_sum,
+                           [=] AMREX_GPU_DEVICE (int i) -> ReduceTupleSum
+                           {
+                               return (p_keys[i] <= min_key) ? 1 : 0;
+                           });
+        nkeep = amrex::get<0>(reduce_data_sum.value());
+    }
 
+    const int nmove = np - nkeep;
+    if (nmove > 0) {
+        // Counting sort of the particles [nkeep, np), all of which go after the kept particles
+        m_move_counts.resize(0);
+        m_move_counts.resize(num_keys, 0);
+        m_move_offsets.resize(num_keys);
+        m_perm.resize(nmove);
+        auto p_move_counts = m_move_counts.dataPtr();
+        auto p_perm = m_perm.dataPtr();
+        AMREX_FOR_1D ( nmove, i,
+        {
+            p_perm[i] = amrex::Gpu::Atomic::Inc(&p_move_counts[p_keys[nkeep+i]], max_unsigned_int);
+        });
+        amrex::Gpu::exclusive_scan(m_move_counts.begin(), m_move_counts.end(),
+                                   m_move_offsets.begin());
+        auto p_move_offsets = m_move_offsets.dataPtr();
+        m_tmp.resize(nmove);
+        const auto src = a_beam.getConstParticleTileData();
+        const auto tmp = m_tmp.getParticleTileData();
+        AMREX_FOR_1D ( nmove, i,
+        {
+            amrex::copyParticle(tmp, src, nkeep+i, p_move_offsets[p_keys[nkeep+i]]+p_perm[i]);
+        });
+        const auto tmp_src = m_tmp.getConstParticleTileData();
+        const auto dst = a_beam.getParticleTileData();
+        AMREX_FOR_1D ( nmove, i,
+        {
+            amrex::copyParticle(dst, tmp_src, i, nkeep+i);
+        });
+    }
+    a_beam.m_slice_contiguous = sort_by_slice;
+
+    // Number of particles in and index of the first particle of each box
+    m_box_counts.resize(num_boxes+1);
+    m_box_offsets.resize(num_boxes+1);
+    auto p_box_counts = m_box_counts.dataPtr();
     auto p_box_offsets = m_box_offsets.dataPtr();
-    AMREX_FOR_1D ( np, i,
+    auto p_key_offsets = m_key_offsets.dataPtr();
+    AMREX_FOR_1D ( num_boxes+1, ibox,
     {
-        int dst_box = assign_grid(particle_ptr[i]);
-        if (dst_box < 0) dst_box = num_boxes;
-        p_dst_indices[i] += p_box_offsets[dst_box];
+        p_box_offsets[ibox] = p_key_offsets[p_first_key[ibox]];
+        p_box_counts[ibox] = (ibox < num_boxes) ?
+            p_key_offsets[p_first_key[ibox+1]] - p_key_offsets[p_first_key[ibox]] :
+            p_key_counts[num_keys-1];
     });
-
-    amrex::scatterParticles<amrex::ParticleTile<0, 0, BeamIdx::nattribs, 0>>(tmp, a_beam, np,
-                                                                             dst_indices.dataPtr());
-
-    a_beam.swap(tmp);
+    amrex::Gpu::streamSynchronize();
 }
 
 int
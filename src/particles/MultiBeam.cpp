@@ -16,6 +16,9 @@ MultiBeam::MultiBeam (amrex::AmrCore* /*amr_core*/)
         m_all_beams.emplace_back(BeamParticleContainer(m_names[i]));
     }
     m_n_real_particles.resize(m_nbeams, 0);
+    queryWithParser(pp, "tiled_deposition", m_tiled_deposition);
+    queryWithParser(pp, "sort_bin_size", m_sort_bin_size);
+    queryWithParser(pp, "sort_by_slice", m_sort_by_slice);
 }
 
 amrex::Real
@@ -40,7 +43,8 @@ MultiBeam::DepositCurrentSlice (
         const int nghost = m_all_beams[i].numParticles() - m_n_real_particles[i];
         ::DepositCurrentSlice(m_all_beams[i], fields, geom, lev, islice,
                               a_box_sorter_vec[i].boxOffsetsPtr()[ibox], bins[i],
-                              do_beam_jx_jy_deposition, which_slice, nghost);
+                              do_beam_jx_jy_deposition, which_slice, nghost,
+                              m_tiled_deposition ? m_sort_bin_size : 0);
     }
 }
 
@@ -68,7 +72,7 @@ MultiBeam::sortParticlesByBox (
 {
     a_box_sorter_vec.resize(m_nbeams);
     for (int i=0; i<m_nbeams; i++) {
-        a_box_sorter_vec[i].sortParticlesByBox(m_all_beams[i], a_ba, a_geom);
+        a_box_sorter_vec[i].sortParticlesByBox(m_all_beams[i], a_ba, a_geom, m_sort_by_slice);
     }
 }
 
@@ -12,6 +12,10 @@ MultiPlasma::MultiPlasma (amrex::AmrCore* amr_core)
     getWithParser(pp, "names", m_names);
     queryWithParser(pp, "adaptive_density", m_adaptive_density);
     queryWithParser(pp, "sort_bin_size", m_sort_bin_size);
+    queryWithParser(pp, "tile_rebin_fraction", m_tile_rebin_fraction);
+    queryWithParser(pp, "reorder_locality", m_reorder_locality);
+    queryWithParser(pp, "colored_tile_deposition", m_colored_tile_deposition);
+    queryWithParser(pp, "fused_push_deposit", m_fused_push_deposit);
     m_nominal_density = Hipace::m_normalized_units ? 1. : 1.e23;
     queryWithParser(pp, "nominal_density", m_nominal_density);
 
@@ -87,7 +91,7 @@ MultiPlasma::DepositCurrent (
     for (int i=0; i<m_nplasmas; i++) {
         ::DepositCurrent(m_all_plasmas[i], fields, which_slice, temp_slice,
                          deposit_jx_jy, deposit_jz, deposit_rho, deposit_j_squared,
-                         gm, lev, m_all_bins[i], m_sort_bin_size);
+                         gm, lev, m_all_bins[i], m_sort_bin_size, m_colored_tile_deposition);
     }
 }
 
@@ -102,6 +106,15 @@ MultiPlasma::AdvanceParticles (
     }
 }
 
+void
+MultiPlasma::AdvanceAndDepositParticles (
+    Fields & fields, amrex::Geometry const& gm, bool do_update, int lev)
+{
+    for (int i=0; i<m_nplasmas; i++) {
+        AdvanceAndDepositPlasmaParticles(m_all_plasmas[i], fields, gm, do_update, lev);
+    }
+}
+
 void
 MultiPlasma::ResetParticles (int lev, bool initial)
 {
@@ -109,6 +122,8 @@ MultiPlasma::ResetParticles (int lev, bool initial)
     for (auto& plasma : m_all_plasmas) {
         ResetPlasmaParticles(plasma, lev, initial);
     }
+    // the positions changed, the tiles recorded by the pusher are outdated
+    for (auto& bins : m_all_bins) bins.invalidate();
 }
 
 void
@@ -120,7 +135,8 @@ MultiPlasma::DepositNeutralizingBackground (
             if (m_all_plasmas[i].m_neutralize_background){
                 // current of ions is zero, so they are not deposited.
                 ::DepositCurrent(m_all_plasmas[i], fields, which_slice, false, false, false,
-                                 true, false, gm, lev, m_all_bins[i], m_sort_bin_size);
+                                 true, false, gm, lev, m_all_bins[i], m_sort_bin_size,
+                                 m_colored_tile_deposition);
             }
         }
     }
@@ -159,10 +175,12 @@ void
 MultiPlasma::TileSort (amrex::Box bx, amrex::Geometry geom)
 {
     constexpr int lev = 0;
-    m_all_bins.clear();
-    for (auto& plasma : m_all_plasmas) {
-        m_all_bins.emplace_back(
-            findParticlesInEachTile(lev, bx, m_sort_bin_size, plasma, geom));
+    for (int i=0; i<m_nplasmas; i++) {
+        m_all_bins[i].update(lev, bx, m_sort_bin_size, m_all_plasmas[i], geom,
+                             m_tile_rebin_fraction);
+        if (m_reorder_locality > 0. && m_all_bins[i].locality() < m_reorder_locality) {
+            m_all_bins[i].reorderParticles(lev, m_all_plasmas[i]);
+        }
     }
 }
 
@@ -176,9 +176,30 @@ IonizationModule (const int lev,
 {
     HIPACE_PROFILE("PlasmaParticleContainer::IonizationModule()");
 
+    if (!m_can_ionize) return;
+
+    if        (Hipace::m_depos_order_xy == 0) {
+        IonizationModuleShapeN<0>(lev, geom, fields);
+    } else if (Hipace::m_depos_order_xy == 1) {
+        IonizationModuleShapeN<1>(lev, geom, fields);
+    } else if (Hipace::m_depos_order_xy == 2) {
+        IonizationModuleShapeN<2>(lev, geom, fields);
+    } else if (Hipace::m_depos_order_xy == 3) {
+        IonizationModuleShapeN<3>(lev, geom, fields);
+    } else {
+        amrex::Abort("unknow deposition order");
+    }
+}
+
+template <int depos_order_xy>
+void
+PlasmaParticleContainer::
+IonizationModuleShapeN (const int lev,
+                        const amrex::Geometry& geom,
+                        Fields& fields)
+{
     using namespace amrex::literals;
 
-    if (!m_can_ionize) return;
     // Extract properties associated with physical size of the box
     amrex::Real const * AMREX_RESTRICT dx = geom.CellSize();
     const PhysConst phys_const = make_constants_SI();
@@ -188,12 +209,12 @@ IonizationModule (const int lev,
     {
         // Extract the fields
         const amrex::MultiFab& S = fields.getSlices(lev, WhichSlice::This);
-        const amrex::MultiFab exmby(S, amrex::make_alias, Comps[WhichSlice::This]["ExmBy"], 1);
-        const amrex::MultiFab eypbx(S, amrex::make_alias, Comps[WhichSlice::This]["EypBx"], 1);
-        const amrex::MultiFab ez(S, amrex::make_alias, Comps[WhichSlice::This]["Ez"], 1);
-        const amrex::MultiFab bx(S, amrex::make_alias, Comps[WhichSlice::This]["Bx"], 1);
-        const amrex::MultiFab by(S, amrex::make_alias, Comps[WhichSlice::This]["By"], 1);
-        const amrex::MultiFab bz(S, amrex::make_alias, Comps[WhichSlice::This]["Bz"], 1);
+        const amrex::MultiFab exmby(S, amrex::make_alias, FieldComps::This::ExmBy, 1);
+        const amrex::MultiFab eypbx(S, amrex::make_alias, FieldComps::This::EypBx, 1);
+        const amrex::MultiFab ez(S, amrex::make_alias, FieldComps::This::Ez, 1);
+        const amrex::MultiFab bx(S, amrex::make_alias, FieldComps::This::Bx, 1);
+        const amrex::MultiFab by(S, amrex::make_alias, FieldComps::This::By, 1);
+        const amrex::MultiFab bz(S, amrex::make_alias, FieldComps::This::Bz, 1);
         // Extract FabArray for this box
         const amrex::FArrayBox& exmby_fab = exmby[mfi_ion];
         const amrex::FArrayBox& eypbx_fab = eypbx[mfi_ion];
@@ -216,8 +237,6 @@ IonizationModule (const int lev,
         const amrex::Real y_pos_offset = GetPosOffset(1, geom, ez_fab.box());
         amrex::Real const z_pos_offset = GetPosOffset(2, geom, ez_fab.box());
 
-        const int depos_order_xy = Hipace::m_depos_order_xy;
-
         auto& plevel_ion = GetParticles(lev);
         auto index = std::make_pair(mfi_ion.index(), mfi_ion.LocalTileIndex());
         if(plevel_ion.find(index) == plevel_ion.end()) continue;
@@ -232,16 +251,15 @@ IonizationModule (const int lev,
         const amrex::Real clightsq = 1.0_rt / ( phys_const.c * phys_const.c );
 
         int * const ion_lev = soa_ion.GetIntData(PlasmaIdx::ion_lev).data();
-        const amrex::Real * const uxp = soa_ion.GetRealData(PlasmaIdx::ux).data();
-        const amrex::Real * const uyp = soa_ion.GetRealData(PlasmaIdx::uy).data();
-        const amrex::Real * const psip = soa_ion.GetRealData(PlasmaIdx::psi).data();
-        const amrex::Real * const const_of_motion = soa_ion.GetRealData(
+        const amrex::ParticleReal * const uxp = soa_ion.GetRealData(PlasmaIdx::ux).data();
+        const amrex::ParticleReal * const uyp = soa_ion.GetRealData(PlasmaIdx::uy).data();
+        const amrex::ParticleReal * const psip = soa_ion.GetRealData(PlasmaIdx::psi).data();
+        const amrex::ParticleReal * const const_of_motion = soa_ion.GetRealData(
                                                                 PlasmaIdx::const_of_motion).data();
 
         // Make Ion Mask and load ADK prefactors
         // Ion Mask is necessary to only resize electron particle tile once
-        amrex::Gpu::DeviceVector<uint8_t> ion_mask(ptile_ion.numParticles(), 0);
-        uint8_t* AMREX_RESTRICT p_ion_mask = ion_mask.data();
+        uint8_t* AMREX_RESTRICT p_ion_mask = fields.getIonMaskWorkspace(ptile_ion.numParticles());
         amrex::Gpu::DeviceScalar<uint32_t> num_new_electrons(0);
         uint32_t* AMREX_RESTRICT p_num_new_electrons = num_new_electrons.dataPtr();
         amrex::Real* AMREX_RESTRICT adk_prefactor = m_adk_prefactor.data();
@@ -263,11 +281,10 @@ IonizationModule (const int lev,
             amrex::ParticleReal ExmByp = 0., EypBxp = 0., Ezp = 0.;
             amrex::ParticleReal Bxp = 0., Byp = 0., Bzp = 0.;
 
-            doGatherShapeN(xp, yp,  0 /* zp not used */,
+            doGatherShapeN<depos_order_xy, 0>(xp, yp,  0 /* zp not used */,
                            ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
                            exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
-                           dx_arr, x_pos_offset, y_pos_offset, z_pos_offset,
-                           depos_order_xy, 0);
+                           dx_arr, x_pos_offset, y_pos_offset, z_pos_offset);
 
             const amrex::ParticleReal Exp = ExmByp + Byp * phys_const.c;
             const amrex::ParticleReal Eyp = EypBxp - Bxp * phys_const.c;
@@ -351,31 +368,9 @@ IonizationModule (const int lev,
                 arrdata_elec[PlasmaIdx::ux_temp ][pidx] = 0._rt;
                 arrdata_elec[PlasmaIdx::uy_temp ][pidx] = 0._rt;
                 arrdata_elec[PlasmaIdx::psi_temp][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fx1     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fx2     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fx3     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fx4     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fx5     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fy1     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fy2     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fy3     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fy4     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fy5     ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fux1    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fux2    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fux3    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fux4    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fux5    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fuy1    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fuy2    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fuy3    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fuy4    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fuy5    ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fpsi1   ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fpsi2   ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fpsi3   ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fpsi4   ][pidx] = 0._rt;
-                arrdata_elec[PlasmaIdx::Fpsi5   ][pidx] = 0._rt;
+                for (int i = PlasmaIdx::Fx1; i < PlasmaIdx::nattribs; ++i) {
+                    arrdata_elec[i][pidx] = 0._rt;
+                }
                 arrdata_elec[PlasmaIdx::x0      ][pidx] = arrdata_ion[PlasmaIdx::x0    ][ip];
                 arrdata_elec[PlasmaIdx::y0      ][pidx] = arrdata_ion[PlasmaIdx::y0    ][ip];
                 // later we could consider adding a finite temperature to the ionized electrons
@@ -160,31 +160,9 @@ InitParticles (const amrex::IntVect& a_num_particles_per_cell,
                 arrdata[PlasmaIdx::ux_temp  ][pidx] = u[0] * c_light;
                 arrdata[PlasmaIdx::uy_temp  ][pidx] = u[1] * c_light;
                 arrdata[PlasmaIdx::psi_temp ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fx1      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fx2      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fx3      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fx4      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fx5      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fy1      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fy2      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fy3      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fy4      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fy5      ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fux1     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fux2     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fux3     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fux4     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fux5     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fuy1     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fuy2     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fuy3     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fuy4     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fuy5     ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fpsi1    ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fpsi2    ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fpsi3    ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fpsi4    ][pidx] = 0.;
-                arrdata[PlasmaIdx::Fpsi5    ][pidx] = 0.;
+                for (int i = PlasmaIdx::Fx1; i < PlasmaIdx::nattribs; ++i) {
+                    arrdata[i][pidx] = 0.;
+                }
                 arrdata[PlasmaIdx::x0       ][pidx] = x;
                 arrdata[PlasmaIdx::y0       ][pidx] = y;
                 int_arrdata[PlasmaIdx::ion_lev][pidx] = init_ion_lev;
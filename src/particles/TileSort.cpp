@@ -3,46 +3,324 @@
 
 #include <AMReX_ParticleTransformation.H>
 
-PlasmaBins
-findParticlesInEachTile (
-    int lev, amrex::Box bx, int bin_size,
-    PlasmaParticleContainer& plasma, const amrex::Geometry& geom)
+#include <algorithm>
+
+#ifdef AMREX_USE_OMP
+#   include <omp.h>
+#endif
+
+namespace
 {
-    HIPACE_PROFILE("findParticlesInEachTile()");
+    /** \brief Index of cell (i, j) along a Morton (Z-order) curve, for i, j < 2^16 */
+    unsigned int MortonIndex (unsigned int i, unsigned int j)
+    {
+        auto spread = [] (unsigned int v) {
+            v &= 0x0000ffffu;
+            v = (v | (v << 8)) & 0x00ff00ffu;
+            v = (v | (v << 4)) & 0x0f0f0f0fu;
+            v = (v | (v << 2)) & 0x33333333u;
+            v = (v | (v << 1)) & 0x55555555u;
+            return v;
+        };
+        return spread(i) | (spread(j) << 1);
+    }
+}
 
-    // Tile box: only 1 cell longitudinally, same as bx transversally.
+void
+PlasmaBins::update (int lev, amrex::Box bx, int bin_size, PlasmaParticleContainer& plasma,
+                    const amrex::Geometry& geom, amrex::Real max_migrated_fraction)
+{
+    HIPACE_PROFILE("PlasmaBins::update()");
+
+    // Tile box: same as bx transversally, coarsened by the tile size.
     const amrex::Box tcbx = bx.coarsen(bin_size);
-    const amrex::Box cbx = {{tcbx.smallEnd(0),tcbx.smallEnd(1),0}, {tcbx.bigEnd(0),tcbx.bigEnd(1),0}};
 
-    PlasmaBins bins;
+    PlasmaTileIndex tile_index;
+    tile_index.m_plo = {geom.ProbLo(0), geom.ProbLo(1)};
+    tile_index.m_dxi = {geom.InvCellSize(0)/bin_size, geom.InvCellSize(1)/bin_size};
+    tile_index.m_lox = tcbx.smallEnd(0);
+    tile_index.m_loy = tcbx.smallEnd(1);
+    tile_index.m_ntilex = tcbx.length(0);
+    tile_index.m_ntiley = tcbx.length(1);
 
-    // Extract particle structures for this tile
     int count = 0; // number of boxes
     for (PlasmaParticleIterator pti(plasma, lev); pti.isValid(); ++pti) {
         count += 1;
 
-        // Extract box properties
-        const auto lo = lbound(cbx);
-        const auto dxi = amrex::GpuArray<amrex::Real,AMREX_SPACEDIM>({
-                geom.InvCellSizeArray()[0]/bin_size,
-                geom.InvCellSizeArray()[1]/bin_size,
-                1.});
-        const auto plo = geom.ProbLoArray();
-
-        // Find the particles that are in each tile and return collections of indices per tile.
-        bins.build(
-            amrex::BinPolicy::OpenMP, pti.numParticles(), pti.GetArrayOfStructs().begin(), cbx,
-            // Pass lambda function that returns the tile index
-            [=] (const PlasmaParticleContainer::ParticleType& p)
-            noexcept -> amrex::IntVect
-            {
-                return amrex::IntVect(
-                    AMREX_D_DECL(
-                        static_cast<int>((p.pos(0)-plo[0])*dxi[0]-lo.x),
-                        static_cast<int>((p.pos(1)-plo[1])*dxi[1]-lo.y),
-                        0));
-            });
+        const amrex::Long np = pti.numParticles();
+        const auto pstruct = pti.GetArrayOfStructs().begin();
+
+        // Particles are only ever added (ionization), so fewer particles means a new set
+        if (!(tile_index == m_tile_index) || np < m_np) m_tiles_valid = false;
+
+        if (!m_tiles_valid) {
+            m_tile_index = tile_index;
+            m_bin_size = bin_size;
+            m_nbins = tile_index.m_ntilex * tile_index.m_ntiley;
+            m_np = np;
+            m_tile.resize(np);
+            ComputeTiles(pstruct, 0);
+            BuildFromTiles();
+        } else {
+            // The tiles of the existing particles were recorded by the pusher,
+            // only the tiles of the new particles are computed from their positions.
+            const amrex::Long np_old = m_np;
+            m_np = np;
+            m_tile.resize(np);
+            ComputeTiles(pstruct, np_old);
+            const auto max_migrated = static_cast<amrex::Long>(max_migrated_fraction * np);
+            if (!UpdateIncrementally(np_old, max_migrated)) BuildFromTiles();
+        }
+        m_tiles_valid = true;
     }
     AMREX_ALWAYS_ASSERT(count <= 1);
-    return bins;
+}
+
+void
+PlasmaBins::ComputeTiles (const PlasmaParticleContainer::ParticleType* pstruct,
+                          amrex::Long begin)
+{
+    const amrex::Long np = m_np;
+    int * const tile = m_tile.dataPtr();
+    const PlasmaTileIndex tile_index = m_tile_index;
+
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (amrex::Long ip = begin; ip < np; ++ip) {
+        tile[ip] = tile_index(pstruct[ip].pos(0), pstruct[ip].pos(1));
+    }
+}
+
+void
+PlasmaBins::BuildFromTiles ()
+{
+    HIPACE_PROFILE("PlasmaBins::BuildFromTiles()");
+
+    const amrex::Long np = m_np;
+    const int nbins = m_nbins;
+#ifdef AMREX_USE_OMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+    const amrex::Long chunk = (np + nthreads - 1) / nthreads;
+
+    m_perm.resize(np);
+    m_offsets.resize(nbins+1);
+    m_counts.assign(nthreads*nbins, 0);
+    int const * const tile = m_tile.dataPtr();
+    index_type * const perm = m_perm.dataPtr();
+    index_type * const offsets = m_offsets.dataPtr();
+    index_type * const counts = m_counts.data();
+
+    // Each thread counts the particles per tile in its chunk of particles
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int ithread = 0; ithread < nthreads; ++ithread) {
+        index_type * const cnt = counts + ithread*nbins;
+        const amrex::Long end = std::min(np, (ithread+1)*chunk);
+        for (amrex::Long ip = ithread*chunk; ip < end; ++ip) ++cnt[tile[ip]];
+    }
+
+    // Exclusive scan ordered by tile, then thread: counts becomes the write position
+    index_type sum = 0;
+    for (int t = 0; t < nbins; ++t) {
+        offsets[t] = sum;
+        for (int ithread = 0; ithread < nthreads; ++ithread) {
+            const index_type c = counts[ithread*nbins+t];
+            counts[ithread*nbins+t] = sum;
+            sum += c;
+        }
+    }
+    offsets[nbins] = sum;
+
+    // Scatter, the particles of a tile are in increasing order
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int ithread = 0; ithread < nthreads; ++ithread) {
+        index_type * const cnt = counts + ithread*nbins;
+        const amrex::Long end = std::min(np, (ithread+1)*chunk);
+        for (amrex::Long ip = ithread*chunk; ip < end; ++ip) {
+            perm[cnt[tile[ip]]++] = static_cast<index_type>(ip);
+        }
+    }
+}
+
+bool
+PlasmaBins::UpdateIncrementally (amrex::Long np_old, amrex::Long max_migrated)
+{
+    HIPACE_PROFILE("PlasmaBins::UpdateIncrementally()");
+
+    const int nbins = m_nbins;
+#ifdef AMREX_USE_OMP
+    const int nthreads = omp_get_max_threads();
+#else
+    const int nthreads = 1;
+#endif
+
+    // leave[t]: number of particles that left tile t,
+    // arrive[t]: start of the particles arriving in tile t in the sorted list of migrants
+    m_counts.assign(2*nbins+1, 0);
+    index_type * const leave = m_counts.data();
+    index_type * const arrive = m_counts.data() + nbins;
+    m_migrants.resize(nthreads);
+    for (auto& m : m_migrants) m.clear();
+    auto * const migrants = m_migrants.data();
+    int const * const tile = m_tile.dataPtr();
+    index_type const * const perm = m_perm.dataPtr();
+    index_type const * const offsets = m_offsets.dataPtr();
+
+    // Collect the particles whose tile, as recorded by the pusher, changed
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+    {
+#ifdef AMREX_USE_OMP
+        const int ithread = omp_get_thread_num();
+#pragma omp for
+#else
+        const int ithread = 0;
+#endif
+        for (int t = 0; t < nbins; ++t) {
+            for (index_type i = offsets[t]; i < offsets[t+1]; ++i) {
+                const index_type ip = perm[i];
+                if (tile[ip] != t) {
+                    migrants[ithread].emplace_back(tile[ip], ip);
+                    ++leave[t];
+                }
+            }
+        }
+    }
+
+    // Merge the per-thread lists, and add the particles created since the last update
+    auto& all = m_migrants[0];
+    for (int ithread = 1; ithread < nthreads; ++ithread) {
+        all.insert(all.end(), m_migrants[ithread].begin(), m_migrants[ithread].end());
+    }
+    for (amrex::Long ip = np_old; ip < m_np; ++ip) {
+        all.emplace_back(tile[ip], static_cast<index_type>(ip));
+    }
+    if (static_cast<amrex::Long>(all.size()) > max_migrated) return false;
+    if (all.empty()) return true;
+    std::sort(all.begin(), all.end());
+
+    // New tile sizes: stayed + arrived
+    m_offsets_tmp.resize(nbins+1);
+    index_type * const new_offsets = m_offsets_tmp.dataPtr();
+    index_type sum = 0;
+    std::size_t j = 0;
+    for (int t = 0; t < nbins; ++t) {
+        new_offsets[t] = sum;
+        arrive[t] = static_cast<index_type>(j);
+        while (j < all.size() && all[j].first == t) ++j;
+        sum += offsets[t+1] - offsets[t] - leave[t] + (static_cast<index_type>(j) - arrive[t]);
+    }
+    arrive[nbins] = static_cast<index_type>(j);
+    new_offsets[nbins] = sum;
+
+    // Per tile, copy the particles that stayed in order, then append the arrived ones
+    m_perm_tmp.resize(m_np);
+    index_type * const new_perm = m_perm_tmp.dataPtr();
+    auto const * const arrivals = all.data();
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+    for (int t = 0; t < nbins; ++t) {
+        index_type k = new_offsets[t];
+        for (index_type i = offsets[t]; i < offsets[t+1]; ++i) {
+            if (tile[perm[i]] == t) new_perm[k++] = perm[i];
+        }
+        for (index_type a = arrive[t]; a < arrive[t+1]; ++a) new_perm[k++] = arrivals[a].second;
+    }
+
+    m_perm.swap(m_perm_tmp);
+    m_offsets.swap(m_offsets_tmp);
+    return true;
+}
+
+amrex::Real
+PlasmaBins::locality () const
+{
+    const int nbins = m_nbins;
+    index_type const * const perm = m_perm.dataPtr();
+    index_type const * const offsets = m_offsets.dataPtr();
+
+    amrex::Long nsequential = 0;
+    amrex::Long npairs = 0;
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for reduction(+:nsequential,npairs)
+#endif
+    for (int t = 0; t < nbins; ++t) {
+        for (index_type i = offsets[t]+1; i < offsets[t+1]; ++i) {
+            if (perm[i] == perm[i-1]+1) ++nsequential;
+            ++npairs;
+        }
+    }
+    return npairs > 0 ? static_cast<amrex::Real>(nsequential) / npairs : 1.;
+}
+
+void
+PlasmaBins::reorderParticles (int lev, PlasmaParticleContainer& plasma)
+{
+    HIPACE_PROFILE("PlasmaBins::reorderParticles()");
+
+    for (PlasmaParticleIterator pti(plasma, lev); pti.isValid(); ++pti) {
+        const amrex::Long np = pti.numParticles();
+        AMREX_ALWAYS_ASSERT_WITH_MESSAGE(m_tiles_valid && np == m_np,
+            "The plasma bins must be updated before reordering the particles");
+
+        const auto pstruct = pti.GetArrayOfStructs().begin();
+        const int nbins = m_nbins;
+        const int bin_size = m_bin_size;
+        const PlasmaTileIndex ti = m_tile_index;
+        int * const tile = m_tile.dataPtr();
+        index_type * const perm = m_perm.dataPtr();
+        index_type const * const offsets = m_offsets.dataPtr();
+
+        // Sort the particles of each tile along a Morton curve of their cell index in the tile.
+        // Afterwards, perm lists the particles in their new order.
+#ifdef AMREX_USE_OMP
+#pragma omp parallel
+#endif
+        {
+            amrex::Vector<std::pair<unsigned int, index_type>> keys;
+#ifdef AMREX_USE_OMP
+#pragma omp for
+#endif
+            for (int t = 0; t < nbins; ++t) {
+                const int cx0 = (t / ti.m_ntiley + ti.m_lox) * bin_size;
+                const int cy0 = (t % ti.m_ntiley + ti.m_loy) * bin_size;
+                keys.clear();
+                for (index_type i = offsets[t]; i < offsets[t+1]; ++i) {
+                    const index_type ip = perm[i];
+                    const auto& p = pstruct[ip];
+                    const int cx = static_cast<int>((p.pos(0)-ti.m_plo[0])*ti.m_dxi[0]*bin_size);
+                    const int cy = static_cast<int>((p.pos(1)-ti.m_plo[1])*ti.m_dxi[1]*bin_size);
+                    keys.emplace_back(
+                        MortonIndex(amrex::min(amrex::max(cx-cx0, 0), bin_size-1),
+                                    amrex::min(amrex::max(cy-cy0, 0), bin_size-1)), ip);
+                }
+                std::sort(keys.begin(), keys.end());
+                for (std::size_t k = 0; k < keys.size(); ++k) {
+                    perm[offsets[t]+k] = keys[k].second;
+                    tile[offsets[t]+k] = t;
+                }
+            }
+        }
+
+        auto& ptile = pti.GetParticleTile();
+        PlasmaParticleContainer::ParticleTileType tmp;
+        tmp.resize(np);
+        amrex::gatherParticles(tmp, ptile, np, perm);
+        ptile.swap(tmp);
+
+        // The particles are now stored in tile order
+#ifdef AMREX_USE_OMP
+#pragma omp parallel for
+#endif
+        for (amrex::Long i = 0; i < np; ++i) perm[i] = static_cast<index_type>(i);
+    }
 }
@@ -12,7 +12,8 @@ void
 DepositCurrentSlice (BeamParticleContainer& beam, Fields& fields,
                      amrex::Vector<amrex::Geometry> const& gm, int const lev ,const int islice,
                      int const offset, BeamBins& bins,
-                     const bool do_beam_jx_jy_deposition, const int which_slice, int nghost)
+                     const bool do_beam_jx_jy_deposition, const int which_slice, int nghost,
+                     const int bin_size)
 {
     HIPACE_PROFILE("DepositCurrentSlice_BeamParticleContainer()");
     // Extract properties associated with physical size of the box
@@ -33,9 +34,18 @@ DepositCurrentSlice (BeamParticleContainer& beam, Fields& fields,
     amrex::MultiFab& S = fields.getSlices(lev, which_slice);
     // we deposit to the beam currents, because the explicit solver
     // requires sometimes just the beam currents
-    amrex::MultiFab jx_beam(S, amrex::make_alias, Comps[which_slice]["jx_beam"], 1);
-    amrex::MultiFab jy_beam(S, amrex::make_alias, Comps[which_slice]["jy_beam"], 1);
-    amrex::MultiFab jz_beam(S, amrex::make_alias, Comps[which_slice]["jz_beam"], 1);
+    // jz_beam only exists in WhichSlice::This, and is only deposited there
+    int ijx_beam = FieldComps::Next::jx_beam;
+    int ijy_beam = FieldComps::Next::jy_beam;
+    int ijz_beam = 0;
+    if (which_slice == WhichSlice::This) {
+        ijx_beam = FieldComps::This::jx_beam;
+        ijy_beam = FieldComps::This::jy_beam;
+        ijz_beam = FieldComps::This::jz_beam;
+    }
+    amrex::MultiFab jx_beam(S, amrex::make_alias, ijx_beam, 1);
+    amrex::MultiFab jy_beam(S, amrex::make_alias, ijy_beam, 1);
+    amrex::MultiFab jz_beam(S, amrex::make_alias, ijz_beam, 1);
 
     // Extract FabArray for this box (because there is currently no transverse
     // parallelization, the index we want in the slice multifab is always 0.
@@ -60,23 +70,26 @@ DepositCurrentSlice (BeamParticleContainer& beam, Fields& fields,
     // For now: fix the value of the charge
     const amrex::Real q = beam.m_charge * lev_weight_fac;
 
+    // The particles of a slice are contiguous if sorted by slice, which is done on level 0
+    const bool slice_contiguous = beam.m_slice_contiguous && lev == 0;
+
     // Call deposition function in each box
     if        (Hipace::m_depos_order_xy == 0){
         doDepositionShapeN<0, 0>( beam, jxb_fab, jyb_fab, jzb_fab, dx, x_pos_offset, y_pos_offset,
-                                  z_pos_offset, q, islice, bins, offset, do_beam_jx_jy_deposition,
-                                  which_slice, nghost);
+                                  z_pos_offset, q, islice, bins, slice_contiguous, offset, do_beam_jx_jy_deposition,
+                                  which_slice, nghost, bin_size);
     } else if (Hipace::m_depos_order_xy == 1){
         doDepositionShapeN<1, 0>( beam, jxb_fab, jyb_fab, jzb_fab, dx, x_pos_offset, y_pos_offset,
-                                  z_pos_offset, q, islice, bins, offset, do_beam_jx_jy_deposition,
-                                  which_slice, nghost);
+                                  z_pos_offset, q, islice, bins, slice_contiguous, offset, do_beam_jx_jy_deposition,
+                                  which_slice, nghost, bin_size);
     } else if (Hipace::m_depos_order_xy == 2){
         doDepositionShapeN<2, 0>( beam, jxb_fab, jyb_fab, jzb_fab, dx, x_pos_offset, y_pos_offset,
-                                  z_pos_offset, q, islice, bins, offset, do_beam_jx_jy_deposition,
-                                  which_slice, nghost);
+                                  z_pos_offset, q, islice, bins, slice_contiguous, offset, do_beam_jx_jy_deposition,
+                                  which_slice, nghost, bin_size);
     } else if (Hipace::m_depos_order_xy == 3){
         doDepositionShapeN<3, 0>( beam, jxb_fab, jyb_fab, jzb_fab, dx, x_pos_offset, y_pos_offset,
-                                  z_pos_offset, q, islice, bins, offset, do_beam_jx_jy_deposition,
-                                  which_slice, nghost);
+                                  z_pos_offset, q, islice, bins, slice_contiguous, offset, do_beam_jx_jy_deposition,
+                                  which_slice, nghost, bin_size);
     } else {
         amrex::Abort("unknown deposition order");
     }
@@ -12,7 +12,7 @@ DepositCurrent (PlasmaParticleContainer& plasma, Fields & fields,
                 const int which_slice, const bool temp_slice,
                 const bool deposit_jx_jy, const bool deposit_jz, const bool deposit_rho,
                 bool deposit_j_squared, amrex::Geometry const& gm, int const lev,
-                PlasmaBins& bins, int bin_size)
+                PlasmaBins& bins, int bin_size, bool colored_tile_deposition)
 {
     HIPACE_PROFILE("DepositCurrent_PlasmaParticleContainer()");
 
@@ -36,14 +36,31 @@ DepositCurrent (PlasmaParticleContainer& plasma, Fields & fields,
     for (PlasmaParticleIterator pti(plasma, lev); pti.isValid(); ++pti)
     {
         // Extract the fields currents
+        // Components that do not exist in which_slice alias component 0. They are never written
+        // to, as the corresponding deposit_* flag is false for these slices.
         amrex::MultiFab& S = fields.getSlices(lev, which_slice);
-        amrex::MultiFab jx(S, amrex::make_alias, Comps[which_slice]["jx"], 1);
-        amrex::MultiFab jy(S, amrex::make_alias, Comps[which_slice]["jy"], 1);
-        amrex::MultiFab jz(S, amrex::make_alias, Comps[which_slice]["jz"], 1);
-        amrex::MultiFab rho(S, amrex::make_alias, Comps[which_slice]["rho"], 1);
-        amrex::MultiFab jxx(S, amrex::make_alias, Comps[which_slice]["jxx"], 1);
-        amrex::MultiFab jxy(S, amrex::make_alias, Comps[which_slice]["jxy"], 1);
-        amrex::MultiFab jyy(S, amrex::make_alias, Comps[which_slice]["jyy"], 1);
+        int ijx = 0, ijy = 0, ijz = 0, irho = 0, ijxx = 0, ijxy = 0, ijyy = 0;
+        if (which_slice == WhichSlice::This) {
+            ijx = FieldComps::This::jx;
+            ijy = FieldComps::This::jy;
+            ijz = FieldComps::This::jz;
+            irho = FieldComps::This::rho;
+            ijxx = FieldComps::This::jxx;
+            ijxy = FieldComps::This::jxy;
+            ijyy = FieldComps::This::jyy;
+        } else if (which_slice == WhichSlice::Next) {
+            ijx = FieldComps::Next::jx;
+            ijy = FieldComps::Next::jy;
+        } else {
+            irho = FieldComps::RhoIons::rho;
+        }
+        amrex::MultiFab jx(S, amrex::make_alias, ijx, 1);
+        amrex::MultiFab jy(S, amrex::make_alias, ijy, 1);
+        amrex::MultiFab jz(S, amrex::make_alias, ijz, 1);
+        amrex::MultiFab rho(S, amrex::make_alias, irho, 1);
+        amrex::MultiFab jxx(S, amrex::make_alias, ijxx, 1);
+        amrex::MultiFab jxy(S, amrex::make_alias, ijxy, 1);
+        amrex::MultiFab jyy(S, amrex::make_alias, ijyy, 1);
         amrex::Vector<amrex::FArrayBox>& tmp_dens = fields.getTmpDensities();
 
         // Extract FabArray for this box
@@ -64,25 +81,29 @@ DepositCurrent (PlasmaParticleContainer& plasma, Fields & fields,
                                           jxx_fab, jxy_fab, jyy_fab, tmp_dens,
                                           dx, x_pos_offset, y_pos_offset, q, can_ionize, temp_slice,
                                           deposit_jx_jy, deposit_jz, deposit_rho,
-                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size);
+                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size,
+                                          colored_tile_deposition);
         } else if (Hipace::m_depos_order_xy == 1){
                 doDepositionShapeN<1, 0>( pti, jx_fab, jy_fab, jz_fab, rho_fab,
                                           jxx_fab, jxy_fab, jyy_fab, tmp_dens,
                                           dx, x_pos_offset, y_pos_offset, q, can_ionize, temp_slice,
                                           deposit_jx_jy, deposit_jz, deposit_rho,
-                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size);
+                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size,
+                                          colored_tile_deposition);
         } else if (Hipace::m_depos_order_xy == 2){
                 doDepositionShapeN<2, 0>( pti, jx_fab, jy_fab, jz_fab, rho_fab,
                                           jxx_fab, jxy_fab, jyy_fab, tmp_dens,
                                           dx, x_pos_offset, y_pos_offset, q, can_ionize, temp_slice,
                                           deposit_jx_jy, deposit_jz, deposit_rho,
-                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size);
+                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size,
+                                          colored_tile_deposition);
         } else if (Hipace::m_depos_order_xy == 3){
                 doDepositionShapeN<3, 0>( pti, jx_fab, jy_fab, jz_fab, rho_fab,
                                           jxx_fab, jxy_fab, jyy_fab, tmp_dens,
                                           dx, x_pos_offset, y_pos_offset, q, can_ionize, temp_slice,
                                           deposit_jx_jy, deposit_jz, deposit_rho,
-                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size);
+                                          deposit_j_squared, max_qsa_weighting_factor, bins, bin_size,
+                                          colored_tile_deposition);
         } else {
             amrex::Abort("unknow deposition order");
         }
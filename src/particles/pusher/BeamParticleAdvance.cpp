@@ -6,34 +6,45 @@
 #include "utils/HipaceProfilerWrapper.H"
 #include "GetDomainLev.H"
 
+/** \brief Push the beam particles of one slice, see AdvanceBeamParticlesSlice
+ *
+ * \tparam depos_order_xy Order of the transverse shape factor for the field gather
+ * \param[in,out] beam species of which the current is deposited
+ * \param[in] fields the general field class, modified by this function
+ * \param[in] gm Geometry of the simulation, to get the cell size etc.
+ * \param[in] lev MR level
+ * \param[in] islice_local local index of the slice on which the beam particles are pushed
+ * \param[in] box current box to calculate in loop over longutidinal boxes
+ * \param[in] offset offset to the current box
+ * \param[in] bins beam particle container bins, to push only the beam particles on slice islice
+ */
+template <int depos_order_xy>
 void
-AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::Geometry const& gm,
-                           int const lev, const int islice_local, const amrex::Box box,
-                           const int offset, BeamBins& bins)
+doAdvanceBeamParticlesSliceShapeN (BeamParticleContainer& beam, Fields& fields,
+                                   amrex::Geometry const& gm, int const lev,
+                                   const int islice_local, const amrex::Box box,
+                                   const int offset, BeamBins& bins)
 {
-    HIPACE_PROFILE("AdvanceBeamParticlesSlice()");
     using namespace amrex::literals;
 
-    // only finest MR level pushes the beam
-    if (beam.m_finest_level != lev) return;
-
     // Extract properties associated with physical size of the box
     amrex::Real const * AMREX_RESTRICT dx = gm.CellSize();
     const PhysConst phys_const = get_phys_const();
 
     const bool do_z_push = beam.m_do_z_push;
     const int n_subcycles = beam.m_n_subcycles;
-    const amrex::Real dt = Hipace::m_dt / n_subcycles;
-    const int depos_order_xy = Hipace::m_depos_order_xy;
+    const amrex::ParticleReal dt_full = Hipace::m_dt;
+    // with adaptive sub-cycling, each particle does between 1 and n_subcycles sub-cycles
+    const bool adaptive_subcycling = beam.m_adaptive_subcycling && n_subcycles > 1;
 
     // Extract the fields
     const amrex::MultiFab& S = fields.getSlices(lev, WhichSlice::This);
-    const amrex::MultiFab exmby(S, amrex::make_alias, Comps[WhichSlice::This]["ExmBy"], 1);
-    const amrex::MultiFab eypbx(S, amrex::make_alias, Comps[WhichSlice::This]["EypBx"], 1);
-    const amrex::MultiFab ez(S, amrex::make_alias, Comps[WhichSlice::This]["Ez"], 1);
-    const amrex::MultiFab bx(S, amrex::make_alias, Comps[WhichSlice::This]["Bx"], 1);
-    const amrex::MultiFab by(S, amrex::make_alias, Comps[WhichSlice::This]["By"], 1);
-    const amrex::MultiFab bz(S, amrex::make_alias, Comps[WhichSlice::This]["Bz"], 1);
+    const amrex::MultiFab exmby(S, amrex::make_alias, FieldComps::This::ExmBy, 1);
+    const amrex::MultiFab eypbx(S, amrex::make_alias, FieldComps::This::EypBx, 1);
+    const amrex::MultiFab ez(S, amrex::make_alias, FieldComps::This::Ez, 1);
+    const amrex::MultiFab bx(S, amrex::make_alias, FieldComps::This::Bx, 1);
+    const amrex::MultiFab by(S, amrex::make_alias, FieldComps::This::By, 1);
+    const amrex::MultiFab bz(S, amrex::make_alias, FieldComps::This::Bz, 1);
 
     // Extract field array from FabArrays in MultiFabs.
     // (because there is currently no transverse parallelization, the index
@@ -54,9 +65,9 @@ AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::G
 
     // Extract particle properties
     auto& soa = beam.GetStructOfArrays(); // For momenta and weights
-    amrex::Real * const uxp = soa.GetRealData(BeamIdx::ux).data() + offset;
-    amrex::Real * const uyp = soa.GetRealData(BeamIdx::uy).data() + offset;
-    amrex::Real * const uzp = soa.GetRealData(BeamIdx::uz).data() + offset;
+    amrex::ParticleReal * const uxp = soa.GetRealData(BeamIdx::ux).data() + offset;
+    amrex::ParticleReal * const uyp = soa.GetRealData(BeamIdx::uy).data() + offset;
+    amrex::ParticleReal * const uzp = soa.GetRealData(BeamIdx::uz).data() + offset;
 
     const auto getPosition = GetParticlePosition<BeamParticleContainer>(beam, offset);
     const auto setPosition = SetParticlePosition<BeamParticleContainer>(beam, offset);
@@ -78,21 +89,86 @@ AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::G
 
     int const num_particles = cell_stop-cell_start;
 
-    const amrex::Real clightsq = 1.0_rt/(phys_const.c*phys_const.c);
-    const amrex::Real charge_mass_ratio = beam.m_charge / beam.m_mass;
+    // The particles of a slice are contiguous if sorted by slice, which is done on level 0
+    const bool slice_contiguous = beam.m_slice_contiguous && lev == 0;
+
+    const amrex::ParticleReal clightsq = 1.0_prt/(phys_const.c*phys_const.c);
+    const amrex::ParticleReal charge_mass_ratio = beam.m_charge / beam.m_mass;
     const amrex::Real external_ExmBy_slope = Hipace::m_external_ExmBy_slope;
     const amrex::Real external_Ez_slope = Hipace::m_external_Ez_slope;
     const amrex::Real external_Ez_uniform = Hipace::m_external_Ez_uniform;
 
+    // With adaptive sub-cycling, compute the number of sub-cycles of each particle from its local
+    // betatron frequency, and group the particles by number of sub-cycles so that neighboring
+    // threads (GPU warps, CPU vector lanes) run the same number of iterations.
+    // The buffers are members of the beam, so they outlive the push kernel.
+    if (adaptive_subcycling) beam.m_n_sub.resize(num_particles);
+    int const * const p_n_sub = beam.m_n_sub.dataPtr();
+    amrex::DenseBins<int>::index_type const * sub_perm = nullptr;
+    if (adaptive_subcycling && num_particles > 0) {
+        HIPACE_PROFILE("AdvanceBeamParticlesSlice()::adaptive_subcycling");
+        int * const p_n_sub_w = beam.m_n_sub.dataPtr();
+        const amrex::Real dxi = 1._rt/dx[0];
+        const amrex::Real dyi = 1._rt/dx[1];
+        const amrex::Real abs_charge_mass_ratio = std::abs(charge_mass_ratio);
+        // number of sub-cycles per radian of betatron phase
+        const amrex::Real nt_per_rad = beam.m_nt_per_betatron / (2._rt*MathConst::pi);
+        const auto flo = amrex::lbound(exmby_arr);
+        const auto fhi = amrex::ubound(exmby_arr);
+        amrex::ParallelFor(
+            num_particles,
+            [=] AMREX_GPU_DEVICE (long idx) {
+                const int ip = slice_contiguous ? cell_start+idx : indices[cell_start+idx];
+                amrex::ParticleReal xp, yp, zp;
+                int pid;
+                getPosition(ip, xp, yp, zp, pid);
+                if (pid < 0) {
+                    p_n_sub_w[idx] = 1;
+                    return;
+                }
+                // transverse gradient of the focusing field, by centered differences around the
+                // nearest node, plus the external focusing field
+                const int i = amrex::min(amrex::max(static_cast<int>(
+                    std::floor((xp-x_pos_offset)*dxi+0.5_rt)), flo.x+1), fhi.x-1);
+                const int j = amrex::min(amrex::max(static_cast<int>(
+                    std::floor((yp-y_pos_offset)*dyi+0.5_rt)), flo.y+1), fhi.y-1);
+                const amrex::Real dfx = std::abs(external_ExmBy_slope + 0.5_rt*dxi*
+                    (exmby_arr(i+1, j, flo.z) - exmby_arr(i-1, j, flo.z)));
+                const amrex::Real dfy = std::abs(external_ExmBy_slope + 0.5_rt*dyi*
+                    (eypbx_arr(i, j+1, flo.z) - eypbx_arr(i, j-1, flo.z)));
+                const amrex::ParticleReal gammap = std::sqrt(
+                    1.0_rt + uxp[ip]*uxp[ip]*clightsq
+                    + uyp[ip]*uyp[ip]*clightsq + uzp[ip]*uzp[ip]*clightsq);
+                const amrex::Real omega_betatron = std::sqrt(
+                    abs_charge_mass_ratio * amrex::max(dfx, dfy) / gammap);
+                const int n = static_cast<int>(std::ceil(omega_betatron * dt_full * nt_per_rad));
+                p_n_sub_w[idx] = amrex::min(amrex::max(n, 1), n_subcycles);
+            });
+        // Bin the particles by number of sub-cycles
+        const amrex::Box sub_box ({0, 0, 0}, {0, 0, n_subcycles-1});
+        beam.m_subcycle_bins.build(
+            num_particles, p_n_sub_w, sub_box,
+            [=] AMREX_GPU_DEVICE (const int& n) noexcept -> amrex::IntVect
+            {
+                return amrex::IntVect(AMREX_D_DECL(0, 0, n-1));
+            });
+        sub_perm = beam.m_subcycle_bins.permutationPtr();
+    }
+
     amrex::ParallelFor(
         num_particles,
         [=] AMREX_GPU_DEVICE (long idx) {
-            const int ip = indices[cell_start+idx];
+            // index of the particle in the slice, grouped by number of sub-cycles if adaptive
+            const int islice_idx = adaptive_subcycling ? sub_perm[idx] : idx;
+            const int ip = slice_contiguous ?
+                cell_start+islice_idx : indices[cell_start+islice_idx];
+            const int n_sub_p = adaptive_subcycling ? p_n_sub[islice_idx] : n_subcycles;
+            const amrex::ParticleReal dt = dt_full / n_sub_p;
 
             amrex::ParticleReal xp, yp, zp;
             int pid;
 
-            for (int i = 0; i < n_subcycles; i++) {
+            for (int i = 0; i < n_sub_p; i++) {
 
                 getPosition(ip, xp, yp, zp, pid);
                 if (pid < 0) return;
@@ -114,11 +190,11 @@ AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::G
                 amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
 
                 // field gather for a single particle
-                doGatherShapeN(xp, yp, 0 /* zp not used */,
-                               ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
-                               exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
-                               dx_arr, x_pos_offset, y_pos_offset, z_pos_offset,
-                               depos_order_xy, 0);
+                doGatherShapeN<depos_order_xy, 0>(
+                    xp, yp, 0 /* zp not used */,
+                    ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
+                    exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                    dx_arr, x_pos_offset, y_pos_offset, z_pos_offset);
 
                 ApplyExternalField(xp, yp, zp, ExmByp, EypBxp, Ezp,
                                    external_ExmBy_slope, external_Ez_slope, external_Ez_uniform);
@@ -167,3 +243,27 @@ AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::G
             } // end for loop over n_subcycles
         });
 }
+
+void
+AdvanceBeamParticlesSlice (BeamParticleContainer& beam, Fields& fields, amrex::Geometry const& gm,
+                           int const lev, const int islice_local, const amrex::Box box,
+                           const int offset, BeamBins& bins)
+{
+    HIPACE_PROFILE("AdvanceBeamParticlesSlice()");
+
+    // only finest MR level pushes the beam
+    if (beam.m_finest_level != lev) return;
+
+    // Dispatch once on the order of the gather, so that the push is fully templated
+    if        (Hipace::m_depos_order_xy == 0) {
+        doAdvanceBeamParticlesSliceShapeN<0>(beam, fields, gm, lev, islice_local, box, offset, bins);
+    } else if (Hipace::m_depos_order_xy == 1) {
+        doAdvanceBeamParticlesSliceShapeN<1>(beam, fields, gm, lev, islice_local, box, offset, bins);
+    } else if (Hipace::m_depos_order_xy == 2) {
+        doAdvanceBeamParticlesSliceShapeN<2>(beam, fields, gm, lev, islice_local, box, offset, bins);
+    } else if (Hipace::m_depos_order_xy == 3) {
+        doAdvanceBeamParticlesSliceShapeN<3>(beam, fields, gm, lev, islice_local, box, offset, bins);
+    } else {
+        amrex::Abort("unknow deposition order");
+    }
+}
@@ -11,26 +11,32 @@
 #include "GetAndSetPosition.H"
 #include "utils/HipaceProfilerWrapper.H"
 #include "particles/ParticleUtil.H"
+#include "particles/ShapeFactors.H"
 
 #include <string>
 
+/** \brief Gather, update the force terms and push the plasma particles, see AdvancePlasmaParticles
+ *
+ * \tparam depos_order_xy Order of the transverse shape factor for the field gather
+ * \param[in,out] plasma plasma species to push
+ * \param[in,out] fields the general field class, modified by this function
+ * \param[in] gm Geometry of the simulation, to get the cell size etc.
+ * \param[in] temp_slice if true, the temporary data (x_temp, ...) will be used
+ * \param[in] do_push boolean to define if plasma particles are pushed
+ * \param[in] do_update boolean to define if the force terms are updated
+ * \param[in] do_shift boolean to define if the force terms are shifted
+ * \param[in] lev MR level
+ * \param[in] bins objects containing indices of plasma particles in each tile
+ */
+template <int depos_order_xy>
 void
-AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
-                        amrex::Geometry const& gm, const bool temp_slice, const bool do_push,
-                        const bool do_update, const bool do_shift, int const lev,
-                        PlasmaBins& bins)
+doAdvancePlasmaParticlesShapeN (PlasmaParticleContainer& plasma, Fields & fields,
+                                amrex::Geometry const& gm, const bool temp_slice,
+                                const bool do_push, const bool do_update, const bool do_shift,
+                                int const lev, PlasmaBins& bins)
 {
-    std::string str = "UpdateForcePushParticles_Plasma(    )";
-    if (temp_slice) str.at(32) = 't';
-    if (do_push) str.at(33) = 'p';
-    if (do_update) str.at(34) = 'u';
-    if (do_shift) str.at(35) = 's';
-    HIPACE_PROFILE(str);
     using namespace amrex::literals;
 
-    // only push plasma particles on their according MR level
-    if (plasma.m_level != lev) return;
-
     const bool do_tiling = Hipace::m_do_tiling;
 
     // Extract properties associated with physical size of the box
@@ -42,12 +48,12 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
     {
         // Extract the fields
         const amrex::MultiFab& S = fields.getSlices(lev, WhichSlice::This);
-        const amrex::MultiFab exmby(S, amrex::make_alias, Comps[WhichSlice::This]["ExmBy"], 1);
-        const amrex::MultiFab eypbx(S, amrex::make_alias, Comps[WhichSlice::This]["EypBx"], 1);
-        const amrex::MultiFab ez(S, amrex::make_alias, Comps[WhichSlice::This]["Ez"], 1);
-        const amrex::MultiFab bx(S, amrex::make_alias, Comps[WhichSlice::This]["Bx"], 1);
-        const amrex::MultiFab by(S, amrex::make_alias, Comps[WhichSlice::This]["By"], 1);
-        const amrex::MultiFab bz(S, amrex::make_alias, Comps[WhichSlice::This]["Bz"], 1);
+        const amrex::MultiFab exmby(S, amrex::make_alias, FieldComps::This::ExmBy, 1);
+        const amrex::MultiFab eypbx(S, amrex::make_alias, FieldComps::This::EypBx, 1);
+        const amrex::MultiFab ez(S, amrex::make_alias, FieldComps::This::Ez, 1);
+        const amrex::MultiFab bx(S, amrex::make_alias, FieldComps::This::Bx, 1);
+        const amrex::MultiFab by(S, amrex::make_alias, FieldComps::This::By, 1);
+        const amrex::MultiFab bz(S, amrex::make_alias, FieldComps::This::Bz, 1);
         // Extract FabArray for this box
         const amrex::FArrayBox& exmby_fab = exmby[pti];
         const amrex::FArrayBox& eypbx_fab = eypbx[pti];
@@ -78,46 +84,27 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
         }
 
         // loading the data
-        amrex::Real * const uxp = soa.GetRealData(PlasmaIdx::ux).data();
-        amrex::Real * const uyp = soa.GetRealData(PlasmaIdx::uy).data();
-        amrex::Real * const psip = soa.GetRealData(PlasmaIdx::psi).data();
-        const amrex::Real * const const_of_motionp = soa.GetRealData(
+        amrex::ParticleReal * const uxp = soa.GetRealData(PlasmaIdx::ux).data();
+        amrex::ParticleReal * const uyp = soa.GetRealData(PlasmaIdx::uy).data();
+        amrex::ParticleReal * const psip = soa.GetRealData(PlasmaIdx::psi).data();
+        const amrex::ParticleReal * const const_of_motionp = soa.GetRealData(
                                                             PlasmaIdx::const_of_motion).data();
-        amrex::Real * const x_prev = soa.GetRealData(PlasmaIdx::x_prev).data();
-        amrex::Real * const y_prev = soa.GetRealData(PlasmaIdx::y_prev).data();
-        amrex::Real * const ux_temp = soa.GetRealData(PlasmaIdx::ux_temp).data();
-        amrex::Real * const uy_temp = soa.GetRealData(PlasmaIdx::uy_temp).data();
-        amrex::Real * const psi_temp = soa.GetRealData(PlasmaIdx::psi_temp).data();
-
-        amrex::Real * const Fx1 = soa.GetRealData(PlasmaIdx::Fx1).data();
-        amrex::Real * const Fy1 = soa.GetRealData(PlasmaIdx::Fy1).data();
-        amrex::Real * const Fux1 = soa.GetRealData(PlasmaIdx::Fux1).data();
-        amrex::Real * const Fuy1 = soa.GetRealData(PlasmaIdx::Fuy1).data();
-        amrex::Real * const Fpsi1 = soa.GetRealData(PlasmaIdx::Fpsi1).data();
-        amrex::Real * const Fx2 = soa.GetRealData(PlasmaIdx::Fx2).data();
-        amrex::Real * const Fy2 = soa.GetRealData(PlasmaIdx::Fy2).data();
-        amrex::Real * const Fux2 = soa.GetRealData(PlasmaIdx::Fux2).data();
-        amrex::Real * const Fuy2 = soa.GetRealData(PlasmaIdx::Fuy2).data();
-        amrex::Real * const Fpsi2 = soa.GetRealData(PlasmaIdx::Fpsi2).data();
-        amrex::Real * const Fx3 = soa.GetRealData(PlasmaIdx::Fx3).data();
-        amrex::Real * const Fy3 = soa.GetRealData(PlasmaIdx::Fy3).data();
-        amrex::Real * const Fux3 = soa.GetRealData(PlasmaIdx::Fux3).data();
-        amrex::Real * const Fuy3 = soa.GetRealData(PlasmaIdx::Fuy3).data();
-        amrex::Real * const Fpsi3 = soa.GetRealData(PlasmaIdx::Fpsi3).data();
-        amrex::Real * const Fx4 = soa.GetRealData(PlasmaIdx::Fx4).data();
-        amrex::Real * const Fy4 = soa.GetRealData(PlasmaIdx::Fy4).data();
-        amrex::Real * const Fux4 = soa.GetRealData(PlasmaIdx::Fux4).data();
-        amrex::Real * const Fuy4 = soa.GetRealData(PlasmaIdx::Fuy4).data();
-        amrex::Real * const Fpsi4 = soa.GetRealData(PlasmaIdx::Fpsi4).data();
-        amrex::Real * const Fx5 = soa.GetRealData(PlasmaIdx::Fx5).data();
-        amrex::Real * const Fy5 = soa.GetRealData(PlasmaIdx::Fy5).data();
-        amrex::Real * const Fux5 = soa.GetRealData(PlasmaIdx::Fux5).data();
-        amrex::Real * const Fuy5 = soa.GetRealData(PlasmaIdx::Fuy5).data();
-        amrex::Real * const Fpsi5 = soa.GetRealData(PlasmaIdx::Fpsi5).data();
+        amrex::ParticleReal * const x_prev = soa.GetRealData(PlasmaIdx::x_prev).data();
+        amrex::ParticleReal * const y_prev = soa.GetRealData(PlasmaIdx::y_prev).data();
+        amrex::ParticleReal * const ux_temp = soa.GetRealData(PlasmaIdx::ux_temp).data();
+        amrex::ParticleReal * const uy_temp = soa.GetRealData(PlasmaIdx::uy_temp).data();
+        amrex::ParticleReal * const psi_temp = soa.GetRealData(PlasmaIdx::psi_temp).data();
+
+        amrex::ParticleReal * const Fx1 = soa.GetRealData(PlasmaIdx::Fx1).data();
+        amrex::ParticleReal * const Fy1 = soa.GetRealData(PlasmaIdx::Fy1).data();
+        amrex::ParticleReal * const Fux1 = soa.GetRealData(PlasmaIdx::Fux1).data();
+        amrex::ParticleReal * const Fuy1 = soa.GetRealData(PlasmaIdx::Fuy1).data();
+        amrex::ParticleReal * const Fpsi1 = soa.GetRealData(PlasmaIdx::Fpsi1).data();
+        // the force history is read through rd in the pusher
+        const auto rd = soa.realarray();
         int * const ion_lev = soa.GetIntData(PlasmaIdx::ion_lev).data();
 
-        const int depos_order_xy = Hipace::m_depos_order_xy;
-        const amrex::Real clightsq = 1.0_rt/(phys_const.c*phys_const.c);
+        const amrex::ParticleReal clightsq = 1.0_prt/(phys_const.c*phys_const.c);
 
         using PTileType = PlasmaParticleContainer::ParticleTileType;
         const auto getPosition = GetParticlePosition<PTileType>(pti.GetParticleTile());
@@ -125,7 +112,7 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
         const auto enforceBC = EnforceBC<PTileType>(
             pti.GetParticleTile(), GetDomainLev(gm, pti.tilebox(), 1, lev),
             GetDomainLev(gm, pti.tilebox(), 0, lev), gm.isPeriodicArray());
-        const amrex::Real dz = dx[2];
+        const amrex::ParticleReal dz = dx[2];
 
         const amrex::Real charge = plasma.m_charge;
         const amrex::Real mass = plasma.m_mass;
@@ -133,6 +120,13 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
 
         const int ntiles = do_tiling ? bins.numBins() : 1;
 
+        // With tiling, record the tile of each particle after the push,
+        // so that the next tile sort only moves the particles that changed tile.
+        const bool record_tiles = do_tiling && do_push &&
+                                  bins.numParticles() == pti.numParticles();
+        int * const tiles = record_tiles ? bins.tilePtr() : nullptr;
+        const PlasmaTileIndex tile_index = bins.getTileIndex();
+
 #ifdef AMREX_USE_OMP
 #pragma omp parallel for if (amrex::Gpu::notInLaunchRegion())
 #endif
@@ -151,7 +145,10 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
                     int pid;
                     getPosition(ip, xp, yp, zp, pid);
 
-                    if (pid < 0) return;
+                    if (pid < 0) {
+                        if (record_tiles) tiles[ip] = itile;
+                        return;
+                    }
 
                     // define field at particle position reals
                     amrex::ParticleReal ExmByp = 0._rt, EypBxp = 0._rt, Ezp = 0._rt;
@@ -160,11 +157,11 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
                     if (do_update)
                     {
                         // field gather for a single particle
-                        doGatherShapeN(xp, yp, 0 /* zp not used */,
-                                       ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
-                                       exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
-                                       dx_arr, x_pos_offset, y_pos_offset, z_pos_offset,
-                                       depos_order_xy, 0);
+                        doGatherShapeN<depos_order_xy, 0>(
+                            xp, yp, 0 /* zp not used */,
+                            ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
+                            exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                            dx_arr, x_pos_offset, y_pos_offset, z_pos_offset);
                         // update force terms for a single particle
                         const amrex::Real q = can_ionize ? ion_lev[ip] * charge : charge;
                         const amrex::Real psi_factor = phys_const.q_e/(phys_const.m_e*phys_const.c*phys_const.c);
@@ -176,19 +173,250 @@ AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
                     if (do_push)
                     {
                         // push a single particle
-                        PlasmaParticlePush(xp, yp, zp, uxp[ip], uyp[ip], psip[ip], x_prev[ip],
-                                           y_prev[ip], ux_temp[ip], uy_temp[ip], psi_temp[ip],
-                                           Fx1[ip], Fy1[ip], Fux1[ip], Fuy1[ip], Fpsi1[ip],
-                                           Fx2[ip], Fy2[ip], Fux2[ip], Fuy2[ip], Fpsi2[ip],
-                                           Fx3[ip], Fy3[ip], Fux3[ip], Fuy3[ip], Fpsi3[ip],
-                                           Fx4[ip], Fy4[ip], Fux4[ip], Fuy4[ip], Fpsi4[ip],
-                                           Fx5[ip], Fy5[ip], Fux5[ip], Fuy5[ip], Fpsi5[ip],
-                                           dz, temp_slice, ip, SetPosition, enforceBC );
+                        PlasmaParticlePush<PlasmaIdx::ab_order>(
+                            xp, yp, zp, uxp[ip], uyp[ip], psip[ip], x_prev[ip], y_prev[ip],
+                            ux_temp[ip], uy_temp[ip], psi_temp[ip],
+                            rd, dz, temp_slice, ip, SetPosition, enforceBC );
+                        if (record_tiles) {
+                            // read back the position, the boundary conditions may change it
+                            getPosition(ip, xp, yp, zp, pid);
+                            tiles[ip] = pid < 0 ? itile : tile_index(xp, yp);
+                        }
                     }
                     return;
                 }
                 );
         }
+        if (record_tiles) bins.setTilesValid();
+    }
+}
+
+void
+AdvancePlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
+                        amrex::Geometry const& gm, const bool temp_slice, const bool do_push,
+                        const bool do_update, const bool do_shift, int const lev,
+                        PlasmaBins& bins)
+{
+    std::string str = "UpdateForcePushParticles_Plasma(    )";
+    if (temp_slice) str.at(32) = 't';
+    if (do_push) str.at(33) = 'p';
+    if (do_update) str.at(34) = 'u';
+    if (do_shift) str.at(35) = 's';
+    HIPACE_PROFILE(str);
+
+    // only push plasma particles on their according MR level
+    if (plasma.m_level != lev) return;
+
+    // Dispatch once on the order of the gather, so that the update and push are fully templated
+    if        (Hipace::m_depos_order_xy == 0) {
+        doAdvancePlasmaParticlesShapeN<0>(plasma, fields, gm, temp_slice, do_push, do_update,
+                                          do_shift, lev, bins);
+    } else if (Hipace::m_depos_order_xy == 1) {
+        doAdvancePlasmaParticlesShapeN<1>(plasma, fields, gm, temp_slice, do_push, do_update,
+                                          do_shift, lev, bins);
+    } else if (Hipace::m_depos_order_xy == 2) {
+        doAdvancePlasmaParticlesShapeN<2>(plasma, fields, gm, temp_slice, do_push, do_update,
+                                          do_shift, lev, bins);
+    } else if (Hipace::m_depos_order_xy == 3) {
+        doAdvancePlasmaParticlesShapeN<3>(plasma, fields, gm, temp_slice, do_push, do_update,
+                                          do_shift, lev, bins);
+    } else {
+        amrex::Abort("unknow deposition order");
+    }
+}
+
+namespace
+{
+    /** \brief Inner loop of AdvanceAndDepositPlasmaParticles over the particles of one box
+     *
+     * \tparam depos_order_xy Order of the transverse shape factor for gather and deposition
+     * \param[in,out] plasma plasma species to push
+     * \param[in,out] fields the general field class, modified by this function
+     * \param[in] gm Geometry of the simulation, to get the cell size etc.
+     * \param[in] do_update boolean to define if the force terms are updated before the push
+     * \param[in] lev MR level
+     */
+    template <int depos_order_xy>
+    void doAdvanceAndDepositShapeN (PlasmaParticleContainer& plasma, Fields & fields,
+                                    amrex::Geometry const& gm, const bool do_update,
+                                    int const lev)
+    {
+        using namespace amrex::literals;
+
+        amrex::Real const * AMREX_RESTRICT dx = gm.CellSize();
+        const PhysConst phys_const = get_phys_const();
+        const amrex::GpuArray<amrex::Real, 3> dx_arr = {dx[0], dx[1], dx[2]};
+        const amrex::Real dxi = 1._rt/dx[0];
+        const amrex::Real dyi = 1._rt/dx[1];
+        const amrex::Real dzi = 1._rt/dx[2];
+        const amrex::Real invvol = Hipace::m_normalized_units ? 1._rt : dxi*dyi*dzi;
+        const amrex::ParticleReal dz = dx[2];
+        const amrex::ParticleReal clightsq = 1.0_prt/(phys_const.c*phys_const.c);
+        const amrex::Real clightsq_depos = 1.0_rt/(phys_const.c*phys_const.c);
+        const amrex::Real psi_factor = phys_const.q_e/(phys_const.m_e*phys_const.c*phys_const.c);
+
+        const amrex::Real charge = plasma.m_charge;
+        const amrex::Real mass = plasma.m_mass;
+        const bool can_ionize = plasma.m_can_ionize;
+        const amrex::Real max_qsa_weighting_factor = plasma.m_max_qsa_weighting_factor;
+
+        amrex::Gpu::DeviceScalar<int> gpu_n_qsa_violation(0);
+        int* p_n_qsa_violation = gpu_n_qsa_violation.dataPtr();
+
+        for (PlasmaParticleIterator pti(plasma, lev); pti.isValid(); ++pti)
+        {
+            // Fields of this slice, to update the force terms
+            const amrex::MultiFab& S = fields.getSlices(lev, WhichSlice::This);
+            amrex::Array4<const amrex::Real> const exmby_arr =
+                S[pti].const_array(FieldComps::This::ExmBy);
+            amrex::Array4<const amrex::Real> const eypbx_arr =
+                S[pti].const_array(FieldComps::This::EypBx);
+            amrex::Array4<const amrex::Real> const ez_arr = S[pti].const_array(FieldComps::This::Ez);
+            amrex::Array4<const amrex::Real> const bx_arr = S[pti].const_array(FieldComps::This::Bx);
+            amrex::Array4<const amrex::Real> const by_arr = S[pti].const_array(FieldComps::This::By);
+            amrex::Array4<const amrex::Real> const bz_arr = S[pti].const_array(FieldComps::This::Bz);
+            // Currents of the next slice, for the deposition
+            amrex::FArrayBox& next_fab = fields.getSlices(lev, WhichSlice::Next)[pti];
+            amrex::Array4<amrex::Real> const jx_arr = next_fab.array(FieldComps::Next::jx);
+            amrex::Array4<amrex::Real> const jy_arr = next_fab.array(FieldComps::Next::jy);
+
+            // Offset for converting positions to indexes
+            const amrex::Real x_pos_offset = GetPosOffset(0, gm, S[pti].box());
+            const amrex::Real y_pos_offset = GetPosOffset(1, gm, S[pti].box());
+            const amrex::Real z_pos_offset = GetPosOffset(2, gm, S[pti].box());
+            const int z_index = pti.tilebox().smallEnd(2);
+
+            auto& soa = pti.GetStructOfArrays();
+            amrex::ParticleReal * const wp = soa.GetRealData(PlasmaIdx::w).data();
+            const amrex::ParticleReal * const uxp = soa.GetRealData(PlasmaIdx::ux).data();
+            const amrex::ParticleReal * const uyp = soa.GetRealData(PlasmaIdx::uy).data();
+            const amrex::ParticleReal * const psip = soa.GetRealData(PlasmaIdx::psi).data();
+            const amrex::ParticleReal * const const_of_motionp = soa.GetRealData(
+                                                                PlasmaIdx::const_of_motion).data();
+            amrex::ParticleReal * const x_prev = soa.GetRealData(PlasmaIdx::x_prev).data();
+            amrex::ParticleReal * const y_prev = soa.GetRealData(PlasmaIdx::y_prev).data();
+            amrex::ParticleReal * const Fx1 = soa.GetRealData(PlasmaIdx::Fx1).data();
+            amrex::ParticleReal * const Fy1 = soa.GetRealData(PlasmaIdx::Fy1).data();
+            amrex::ParticleReal * const Fux1 = soa.GetRealData(PlasmaIdx::Fux1).data();
+            amrex::ParticleReal * const Fuy1 = soa.GetRealData(PlasmaIdx::Fuy1).data();
+            amrex::ParticleReal * const Fpsi1 = soa.GetRealData(PlasmaIdx::Fpsi1).data();
+            // the force history is read through rd in the pusher
+            const auto rd = soa.realarray();
+            const int * const ion_lev = soa.GetIntData(PlasmaIdx::ion_lev).data();
+
+            using PTileType = PlasmaParticleContainer::ParticleTileType;
+            const auto getPosition = GetParticlePosition<PTileType>(pti.GetParticleTile());
+            const auto SetPosition = SetParticlePosition<PTileType>(pti.GetParticleTile());
+            const auto enforceBC = EnforceBC<PTileType>(
+                pti.GetParticleTile(), GetDomainLev(gm, pti.tilebox(), 1, lev),
+                GetDomainLev(gm, pti.tilebox(), 0, lev), gm.isPeriodicArray());
+            auto& aos = pti.GetArrayOfStructs();
+            const auto pos_structs = aos.begin();
+
+            amrex::ParallelFor(
+                pti.numParticles(),
+                [=] AMREX_GPU_DEVICE (long ip) {
+                    amrex::ParticleReal xp, yp, zp;
+                    int pid;
+                    getPosition(ip, xp, yp, zp, pid);
+                    if (pid < 0) return;
+
+                    const amrex::Real q = can_ionize ? ion_lev[ip] * charge : charge;
+
+                    if (do_update) {
+                        amrex::ParticleReal ExmByp = 0._rt, EypBxp = 0._rt, Ezp = 0._rt;
+                        amrex::ParticleReal Bxp = 0._rt, Byp = 0._rt, Bzp = 0._rt;
+                        doGatherShapeN<depos_order_xy, 0>(
+                            xp, yp, 0 /* zp not used */, ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
+                            exmby_arr, eypbx_arr, ez_arr, bx_arr, by_arr, bz_arr,
+                            dx_arr, x_pos_offset, y_pos_offset, z_pos_offset);
+                        UpdateForceTerms(uxp[ip], uyp[ip], psi_factor*psip[ip],
+                                         const_of_motionp[ip], ExmByp, EypBxp, Ezp, Bxp, Byp, Bzp,
+                                         Fx1[ip], Fy1[ip], Fux1[ip], Fuy1[ip], Fpsi1[ip],
+                                         clightsq, phys_const, q, mass);
+                    }
+
+                    // push to the next slice, the pushed momenta are only kept in registers
+                    amrex::ParticleReal ux = uxp[ip], uy = uyp[ip], psi_p = psip[ip];
+                    amrex::ParticleReal ux_next = 0._prt, uy_next = 0._prt, psi_next = 0._prt;
+                    PlasmaParticlePush<PlasmaIdx::ab_order>(
+                        xp, yp, zp, ux, uy, psi_p, x_prev[ip], y_prev[ip],
+                        ux_next, uy_next, psi_next, rd, dz, true, ip, SetPosition, enforceBC);
+                    // the particle may have been removed by the boundary conditions
+                    if (pos_structs[ip].id() < 0) return;
+
+                    // deposit jx and jy to the next slice, as in doDepositionShapeN
+                    const amrex::Real psi = psi_next *
+                        phys_const.q_e / (phys_const.m_e * phys_const.c * phys_const.c);
+                    const amrex::Real psi_com = psi + const_of_motionp[ip];
+                    const amrex::Real gaminv = (2.0_rt * psi_com)
+                        /(1.0_rt + ux_next*ux_next*clightsq_depos + uy_next*uy_next*clightsq_depos
+                          + psi_com*psi_com);
+
+                    if (( 1.0_rt/(gaminv*psi_com) < 0.0_rt) ||
+                        ( 1.0_rt/(gaminv*psi_com) > max_qsa_weighting_factor))
+                    {
+                        // This particle violates the QSA, discard it and do not deposit its current
+                        amrex::Gpu::Atomic::Add(p_n_qsa_violation, 1);
+                        wp[ip] = 0.0_rt;
+                        pos_structs[ip].id() = -std::abs(pos_structs[ip].id());
+                        return;
+                    }
+
+                    const amrex::Real vx = ux_next*gaminv;
+                    const amrex::Real vy = uy_next*gaminv;
+                    const amrex::Real wq = q * wp[ip]/(gaminv * psi_com)*invvol;
+                    const amrex::Real wqx = wq*vx;
+                    const amrex::Real wqy = wq*vy;
+
+                    // the position may have been shifted by periodic boundary conditions
+                    amrex::Real sx_cell[depos_order_xy + 1];
+                    const int j_cell = compute_shape_factor<depos_order_xy>(
+                        sx_cell, (pos_structs[ip].pos(0) - x_pos_offset)*dxi);
+                    amrex::Real sy_cell[depos_order_xy + 1];
+                    const int k_cell = compute_shape_factor<depos_order_xy>(
+                        sy_cell, (pos_structs[ip].pos(1) - y_pos_offset)*dyi);
+                    for (int iy=0; iy<=depos_order_xy; iy++){
+                        for (int ix=0; ix<=depos_order_xy; ix++){
+                            amrex::Gpu::Atomic::Add(&jx_arr(j_cell+ix, k_cell+iy, z_index),
+                                                    sx_cell[ix]*sy_cell[iy]*wqx);
+                            amrex::Gpu::Atomic::Add(&jy_arr(j_cell+ix, k_cell+iy, z_index),
+                                                    sx_cell[ix]*sy_cell[iy]*wqy);
+                        }
+                    }
+                }
+                );
+        }
+
+        const int n_qsa_violation = gpu_n_qsa_violation.dataValue();
+        if (n_qsa_violation > 0 && (Hipace::m_verbose >= 3))
+            amrex::Print()<< "number of QSA violating particles on this slice: " \
+                          << n_qsa_violation << "\n";
+    }
+}
+
+void
+AdvanceAndDepositPlasmaParticles (PlasmaParticleContainer& plasma, Fields & fields,
+                                  amrex::Geometry const& gm, const bool do_update, int const lev)
+{
+    HIPACE_PROFILE("AdvanceAndDepositPlasmaParticles()");
+
+    // only push plasma particles on their according MR level
+    if (plasma.m_level != lev) return;
+
+    AMREX_ALWAYS_ASSERT_WITH_MESSAGE(!Hipace::m_do_tiling,
+        "The fused plasma push and deposition requires hipace.do_tiling = 0");
+
+    if        (Hipace::m_depos_order_xy == 0){
+        doAdvanceAndDepositShapeN<0>(plasma, fields, gm, do_update, lev);
+    } else if (Hipace::m_depos_order_xy == 1){
+        doAdvanceAndDepositShapeN<1>(plasma, fields, gm, do_update, lev);
+    } else if (Hipace::m_depos_order_xy == 2){
+        doAdvanceAndDepositShapeN<2>(plasma, fields, gm, do_update, lev);
+    } else if (Hipace::m_depos_order_xy == 3){
+        doAdvanceAndDepositShapeN<3>(plasma, fields, gm, do_update, lev);
+    } else {
+        amrex::Abort("unknow deposition order");
     }
 }
 
@@ -214,44 +442,21 @@ ResetPlasmaParticles (PlasmaParticleContainer& plasma, int const lev, const bool
         }
 
         auto& soa = pti.GetStructOfArrays(); // For momenta and weights
-        amrex::Real * const uxp = soa.GetRealData(PlasmaIdx::ux).data();
-        amrex::Real * const uyp = soa.GetRealData(PlasmaIdx::uy).data();
-        amrex::Real * const psip = soa.GetRealData(PlasmaIdx::psi).data();
-        amrex::Real * const const_of_motionp = soa.GetRealData(PlasmaIdx::const_of_motion).data();
-        amrex::Real * const x_prev = soa.GetRealData(PlasmaIdx::x_prev).data();
-        amrex::Real * const y_prev = soa.GetRealData(PlasmaIdx::y_prev).data();
-        amrex::Real * const ux_temp = soa.GetRealData(PlasmaIdx::ux_temp).data();
-        amrex::Real * const uy_temp = soa.GetRealData(PlasmaIdx::uy_temp).data();
-        amrex::Real * const psi_temp = soa.GetRealData(PlasmaIdx::psi_temp).data();
-        amrex::Real * const Fx1 = soa.GetRealData(PlasmaIdx::Fx1).data();
-        amrex::Real * const Fy1 = soa.GetRealData(PlasmaIdx::Fy1).data();
-        amrex::Real * const Fux1 = soa.GetRealData(PlasmaIdx::Fux1).data();
-        amrex::Real * const Fuy1 = soa.GetRealData(PlasmaIdx::Fuy1).data();
-        amrex::Real * const Fpsi1 = soa.GetRealData(PlasmaIdx::Fpsi1).data();
-        amrex::Real * const Fx2 = soa.GetRealData(PlasmaIdx::Fx2).data();
-        amrex::Real * const Fy2 = soa.GetRealData(PlasmaIdx::Fy2).data();
-        amrex::Real * const Fux2 = soa.GetRealData(PlasmaIdx::Fux2).data();
-        amrex::Real * const Fuy2 = soa.GetRealData(PlasmaIdx::Fuy2).data();
-        amrex::Real * const Fpsi2 = soa.GetRealData(PlasmaIdx::Fpsi2).data();
-        amrex::Real * const Fx3 = soa.GetRealData(PlasmaIdx::Fx3).data();
-        amrex::Real * const Fy3 = soa.GetRealData(PlasmaIdx::Fy3).data();
-        amrex::Real * const Fux3 = soa.GetRealData(PlasmaIdx::Fux3).data();
-        amrex::Real * const Fuy3 = soa.GetRealData(PlasmaIdx::Fuy3).data();
-        amrex::Real * const Fpsi3 = soa.GetRealData(PlasmaIdx::Fpsi3).data();
-        amrex::Real * const Fx4 = soa.GetRealData(PlasmaIdx::Fx4).data();
-        amrex::Real * const Fy4 = soa.GetRealData(PlasmaIdx::Fy4).data();
-        amrex::Real * const Fux4 = soa.GetRealData(PlasmaIdx::Fux4).data();
-        amrex::Real * const Fuy4 = soa.GetRealData(PlasmaIdx::Fuy4).data();
-        amrex::Real * const Fpsi4 = soa.GetRealData(PlasmaIdx::Fpsi4).data();
-        amrex::Real * const Fx5 = soa.GetRealData(PlasmaIdx::Fx5).data();
-        amrex::Real * const Fy5 = soa.GetRealData(PlasmaIdx::Fy5).data();
-        amrex::Real * const Fux5 = soa.GetRealData(PlasmaIdx::Fux5).data();
-        amrex::Real * const Fuy5 = soa.GetRealData(PlasmaIdx::Fuy5).data();
-        amrex::Real * const Fpsi5 = soa.GetRealData(PlasmaIdx::Fpsi5).data();
-        amrex::Real * const x0 = soa.GetRealData(PlasmaIdx::x0).data();
-        amrex::Real * const y0 = soa.GetRealData(PlasmaIdx::y0).data();
-        amrex::Real * const w = soa.GetRealData(PlasmaIdx::w).data();
-        amrex::Real * const w0 = soa.GetRealData(PlasmaIdx::w0).data();
+        amrex::ParticleReal * const uxp = soa.GetRealData(PlasmaIdx::ux).data();
+        amrex::ParticleReal * const uyp = soa.GetRealData(PlasmaIdx::uy).data();
+        amrex::ParticleReal * const psip = soa.GetRealData(PlasmaIdx::psi).data();
+        amrex::ParticleReal * const const_of_motionp = soa.GetRealData(PlasmaIdx::const_of_motion).data();
+        amrex::ParticleReal * const x_prev = soa.GetRealData(PlasmaIdx::x_prev).data();
+        amrex::ParticleReal * const y_prev = soa.GetRealData(PlasmaIdx::y_prev).data();
+        amrex::ParticleReal * const ux_temp = soa.GetRealData(PlasmaIdx::ux_temp).data();
+        amrex::ParticleReal * const uy_temp = soa.GetRealData(PlasmaIdx::uy_temp).data();
+        amrex::ParticleReal * const psi_temp = soa.GetRealData(PlasmaIdx::psi_temp).data();
+        // the force history is reset through rd
+        const auto rd = soa.realarray();
+        amrex::ParticleReal * const x0 = soa.GetRealData(PlasmaIdx::x0).data();
+        amrex::ParticleReal * const y0 = soa.GetRealData(PlasmaIdx::y0).data();
+        amrex::ParticleReal * const w = soa.GetRealData(PlasmaIdx::w).data();
+        amrex::ParticleReal * const w0 = soa.GetRealData(PlasmaIdx::w0).data();
         int * const ion_lev = soa.GetIntData(PlasmaIdx::ion_lev).data();
 
         const auto GetPosition =
@@ -287,31 +492,9 @@ ResetPlasmaParticles (PlasmaParticleContainer& plasma, int const lev, const bool
                     ux_temp[ip] = 0._rt;
                     uy_temp[ip] = 0._rt;
                     psi_temp[ip] = 0._rt;
-                    Fx1[ip] = 0._rt;
-                    Fy1[ip] = 0._rt;
-                    Fux1[ip] = 0._rt;
-                    Fuy1[ip] = 0._rt;
-                    Fpsi1[ip] = 0._rt;
-                    Fx2[ip] = 0._rt;
-                    Fy2[ip] = 0._rt;
-                    Fux2[ip] = 0._rt;
-                    Fuy2[ip] = 0._rt;
-                    Fpsi2[ip] = 0._rt;
-                    Fx3[ip] = 0._rt;
-                    Fy3[ip] = 0._rt;
-                    Fux3[ip] = 0._rt;
-                    Fuy3[ip] = 0._rt;
-                    Fpsi3[ip] = 0._rt;
-                    Fx4[ip] = 0._rt;
-                    Fy4[ip] = 0._rt;
-                    Fux4[ip] = 0._rt;
-                    Fuy4[ip] = 0._rt;
-                    Fpsi4[ip] = 0._rt;
-                    Fx5[ip] = 0._rt;
-                    Fy5[ip] = 0._rt;
-                    Fux5[ip] = 0._rt;
-                    Fuy5[ip] = 0._rt;
-                    Fpsi5[ip] = 0._rt;
+                    for (int i = PlasmaIdx::Fx1; i < PlasmaIdx::nattribs; ++i) {
+                        rd[i][ip] = 0._rt;
+                    }
                     ion_lev[ip] = init_ion_lev;
                     const_of_motionp[ip]  = sqrt(1. + u[0]*u[0] + u[1]*u[1] + u[2]*u[2]) - u[2];
                 }
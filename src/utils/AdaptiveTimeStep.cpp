@@ -111,11 +111,14 @@ AdaptiveTimeStep::Calculate (amrex::Real& dt, MultiBeam& beams, amrex::Real plas
 
                 if ( std::abs(wp[ip]) < std::numeric_limits<amrex::Real>::epsilon() ) return;
 
-                amrex::Gpu::Atomic::Add(p_sum_weights, wp[ip]);
-                amrex::Gpu::Atomic::Add(p_sum_weights_times_uz, wp[ip]*uzp[ip]/phys_const.c);
-                amrex::Gpu::Atomic::Add(p_sum_weights_times_uz_squared, wp[ip]*uzp[ip]*uzp[ip]
-                                        /phys_const.c/phys_const.c);
-                amrex::Gpu::Atomic::Min(p_min_uz, uzp[ip]/phys_const.c);
+                // particle data may have a higher precision than the reduced quantities
+                amrex::Gpu::Atomic::Add(p_sum_weights, static_cast<amrex::Real>(wp[ip]));
+                amrex::Gpu::Atomic::Add(p_sum_weights_times_uz,
+                                        static_cast<amrex::Real>(wp[ip]*uzp[ip]/phys_const.c));
+                amrex::Gpu::Atomic::Add(p_sum_weights_times_uz_squared,
+                                        static_cast<amrex::Real>(wp[ip]*uzp[ip]*uzp[ip]
+                                                                 /phys_const.c/phys_const.c));
+                amrex::Gpu::Atomic::Min(p_min_uz, static_cast<amrex::Real>(uzp[ip]/phys_const.c));
 
         }
         );
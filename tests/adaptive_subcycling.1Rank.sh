@@ -0,0 +1,53 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a beam in a linear external focusing field with a time step too large to resolve the
+# betatron oscillation, once with a fixed number of sub-cycles and once with adaptive
+# sub-cycling, and compares both with theory.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/beam_in_vacuum
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_*
+
+run_beam () {
+    mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+            amr.n_cell = 32 32 10 \
+            max_step = 4 \
+            geometry.prob_lo = -2. -2. -2. \
+            geometry.prob_hi =  2.  2.  2. \
+            hipace.dt = 30. \
+            hipace.output_period = 4 \
+            beam.density = 1.e-8 \
+            beam.radius = 1. \
+            beam.ppc = 4 4 1 \
+            hipace.external_ExmBy_slope = .5 \
+            "$@"
+}
+
+# Without sub-cycling, the betatron phase advances by ~0.67 rad per time step
+run_beam beam.n_subcycles = 1 \
+         hipace.file_prefix = ${TEST_NAME}_no_subcycling
+run_beam beam.n_subcycles = 10 \
+         hipace.file_prefix = ${TEST_NAME}_fixed
+# With 40 sub-cycles per betatron period, adaptive sub-cycling uses 5 sub-cycles
+run_beam beam.n_subcycles = 10 \
+         beam.adaptive_subcycling = 1 \
+         beam.nt_per_betatron = 40. \
+         hipace.file_prefix = ${TEST_NAME}_adaptive
+
+# Compare the results with theory and with each other
+$HIPACE_EXAMPLE_DIR/analysis_adaptive_subcycling.py \
+    --no-subcycling ${TEST_NAME}_no_subcycling \
+    --fixed ${TEST_NAME}_fixed \
+    --adaptive ${TEST_NAME}_adaptive
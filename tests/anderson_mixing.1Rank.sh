@@ -0,0 +1,44 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation in the blowout regime with an iterated predictor-corrector loop,
+# once with linear mixing and once with Anderson mixing of the B-field, and checks that both
+# converge to the same fields and that Anderson mixing needs fewer iterations.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_linear
+rm -rf ${TEST_NAME}_anderson
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.predcorr_max_iterations = 50 \
+        hipace.predcorr_B_error_tolerance = 1.e-4 \
+        hipace.predcorr_B_mixing_factor = 0.12 \
+        hipace.verbose = 2 \
+        hipace.file_prefix = ${TEST_NAME}_linear | tee ${TEST_NAME}_linear.txt
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.predcorr_max_iterations = 50 \
+        hipace.predcorr_B_error_tolerance = 1.e-4 \
+        hipace.predcorr_B_mixing_factor = 0.3 \
+        hipace.predcorr_anderson_depth = 3 \
+        hipace.verbose = 2 \
+        hipace.file_prefix = ${TEST_NAME}_anderson | tee ${TEST_NAME}_anderson.txt
+
+# Compare the number of iterations and the results
+$HIPACE_EXAMPLE_DIR/analysis_anderson_mixing.py \
+    --linear ${TEST_NAME}_linear \
+    --anderson ${TEST_NAME}_anderson
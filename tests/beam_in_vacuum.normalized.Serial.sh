@@ -10,6 +10,7 @@ set -eu -o pipefail
 # Read input parameters
 HIPACE_EXECUTABLE=$1
 HIPACE_SOURCE_DIR=$2
+HIPACE_PRECISION=${3:-DOUBLE}
 
 HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/beam_in_vacuum
 HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
@@ -26,8 +27,16 @@ $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
 # Compare the result with theory
 $HIPACE_EXAMPLE_DIR/analysis.py --normalized-units --output-dir=$TEST_NAME
 
+# The benchmark is computed in double precision. With single-precision fields (MIXED), the
+# fields only agree with it up to single-precision round-off errors.
+CHECKSUM_RTOL=1.e-9
+if [ "$HIPACE_PRECISION" = "MIXED" ]; then
+    CHECKSUM_RTOL=1.e-4
+fi
+
 # Compare the results with checksum benchmark
 $HIPACE_TEST_DIR/checksum/checksumAPI.py \
     --evaluate \
+    --rtol $CHECKSUM_RTOL \
     --file_name $TEST_NAME \
     --test-name $TEST_NAME
@@ -0,0 +1,42 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation in the blowout regime with the default plasma current deposition,
+# where each thread adds its tiles to the current arrays with atomic operations, and with
+# plasmas.colored_tile_deposition = 1, where the tiles are added in 4 colors without atomics.
+# With 8x8 cell tiles, each color has 16 tiles that are deposited concurrently with OpenMP.
+# Only the order of the additions changes, so the results must agree up to round-off errors.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+# use several threads, so that tiles of the same color are deposited concurrently
+export OMP_NUM_THREADS=${OMP_NUM_THREADS:-2}
+
+rm -rf ${TEST_NAME}_default
+rm -rf ${TEST_NAME}_colored
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.file_prefix = ${TEST_NAME}_default \
+        max_step = 1
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        plasmas.colored_tile_deposition = 1 \
+        hipace.file_prefix = ${TEST_NAME}_colored \
+        max_step = 1
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_compare_runs.py \
+    --first ${TEST_NAME}_default --second ${TEST_NAME}_colored --tolerance 1.e-9
@@ -0,0 +1,51 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation on 2 ranks with FFTW plans created with FFTW_ESTIMATE, then twice
+# with FFTW_MEASURE and a wisdom file: the first measured run writes the file, the second one
+# imports it. In both measured runs, the wisdom is broadcast from the first rank to the other.
+# The fields and beam must agree with the estimate run up to round-off errors.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_estimate ${TEST_NAME}_measure ${TEST_NAME}_import ${TEST_NAME}_wisdom_*
+
+run_hipace () {
+    mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+            plasmas.sort_bin_size = 8 \
+            max_step = 1 \
+            "$@"
+}
+
+run_hipace hipace.fftw_plan_effort = estimate \
+           hipace.file_prefix = ${TEST_NAME}_estimate
+
+# Measure the plans and write the wisdom file
+run_hipace hipace.fftw_plan_effort = measure \
+           hipace.fftw_wisdom_file = ${TEST_NAME}_wisdom \
+           hipace.file_prefix = ${TEST_NAME}_measure
+ls ${TEST_NAME}_wisdom_*
+
+# Plan from the wisdom file
+run_hipace hipace.fftw_plan_effort = measure \
+           hipace.fftw_wisdom_file = ${TEST_NAME}_wisdom \
+           hipace.file_prefix = ${TEST_NAME}_import | tee ${TEST_NAME}_import.txt
+grep -q "imported FFTW wisdom" ${TEST_NAME}_import.txt
+
+# Measured plans may use other algorithms than estimated ones, so the results only agree up to
+# round-off errors
+$HIPACE_EXAMPLE_DIR/analysis_compare_runs.py \
+    --first ${TEST_NAME}_estimate --second ${TEST_NAME}_measure --tolerance 1.e-9
+$HIPACE_EXAMPLE_DIR/analysis_compare_runs.py \
+    --first ${TEST_NAME}_estimate --second ${TEST_NAME}_import --tolerance 1.e-9
@@ -0,0 +1,31 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with and without the fused plasma push and deposition kernel in the
+# predictor-corrector loop, and checks that the results agree.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.do_tiling = 0 \
+        amr.n_cell = 64 88 100 \
+        plasmas.fused_push_deposit = 0 \
+        hipace.file_prefix=push_deposit_separate
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        hipace.do_tiling = 0 \
+        amr.n_cell = 64 88 100 \
+        plasmas.fused_push_deposit = 1 \
+        hipace.file_prefix=push_deposit_fused
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_fused_push_deposit.py
@@ -0,0 +1,42 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation on 2 ranks with and without load balancing of the boxes in z, and
+# checks that the results agree. With load_balance_threshold = 1, the boxes are moved after every
+# iteration of the time step loop, which exercises the rebalancing and the reception of the
+# particles sent with the old boxes.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+rm -rf load_balance_off
+rm -rf load_balance_on
+# Run the simulation
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.skip_empty_comms = 0 \
+        hipace.verbose = 1 \
+        hipace.file_prefix=load_balance_off \
+        max_step = 5
+
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.skip_empty_comms = 0 \
+        hipace.load_balance_int = 1 \
+        hipace.load_balance_threshold = 1.0 \
+        hipace.verbose = 1 \
+        hipace.file_prefix=load_balance_on \
+        max_step = 5 | tee load_balance_on.txt
+
+# check that the boxes were rebalanced
+grep -q "Load balancing" load_balance_on.txt
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_load_balance.py
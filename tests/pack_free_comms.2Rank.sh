@@ -0,0 +1,30 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs the blowout_wake.2Rank simulation in normalized units with the beam particles sent
+# between ranks without packing, and checks that the result is identical to the packed transfer.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+rm -rf pack_free_data
+# Run the simulation
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.pack_free_comms = 1 \
+        hipace.file_prefix=pack_free_data/ \
+        max_step=1
+
+# Compare the results with the checksum benchmark of the packed transfer
+$HIPACE_TEST_DIR/checksum/checksumAPI.py \
+    --evaluate \
+    --file_name pack_free_data/ \
+    --test-name blowout_wake.2Rank \
+    --skip "{'beam': 'id'}"
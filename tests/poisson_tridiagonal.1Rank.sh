@@ -0,0 +1,31 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation with the DST Poisson solver and with the DST-x / tridiagonal-y
+# Poisson solver, and checks that the results agree.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        amr.n_cell = 64 88 100 \
+        fields.dirichlet_poisson_solver = dst \
+        hipace.file_prefix=poisson_dst
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        amr.n_cell = 64 88 100 \
+        fields.dirichlet_poisson_solver = dst_tridiagonal \
+        hipace.file_prefix=poisson_dst_tridiagonal
+
+# assert whether the two Poisson solvers match
+$HIPACE_EXAMPLE_DIR/analysis_poisson_tridiagonal.py
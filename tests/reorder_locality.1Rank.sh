@@ -0,0 +1,38 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation in the blowout regime with and without reordering the plasma
+# particles in memory by tile. With plasmas.reorder_locality = 1, the particles are reordered at
+# every tile sort where they are not already stored in tile order. The reordering only changes the
+# order of the deposition, so the results must agree with the default run up to round-off errors.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_default
+rm -rf ${TEST_NAME}_reorder
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        hipace.file_prefix = ${TEST_NAME}_default \
+        max_step = 1
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        plasmas.reorder_locality = 1. \
+        hipace.file_prefix = ${TEST_NAME}_reorder \
+        max_step = 1
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_compare_runs.py \
+    --first ${TEST_NAME}_default --second ${TEST_NAME}_reorder --tolerance 1.e-9
@@ -0,0 +1,39 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation in the blowout regime on 2 ranks with and without
+# beams.sort_by_slice. With it, the beam push, current deposition and ghost slice communication
+# access the particles of a slice directly in memory instead of through the slice bins. The
+# particles are processed in another order, so the results must agree up to round-off errors.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_off
+rm -rf ${TEST_NAME}_on
+# Run the simulation for 2 steps, so that the beam is sorted again after it was pushed
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        beams.sort_by_slice = 0 \
+        hipace.file_prefix = ${TEST_NAME}_off \
+        max_step = 2
+
+mpiexec -n 2 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        beams.sort_by_slice = 1 \
+        hipace.file_prefix = ${TEST_NAME}_on \
+        max_step = 2
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_compare_runs.py \
+    --first ${TEST_NAME}_off --second ${TEST_NAME}_on --tolerance 1.e-9
@@ -0,0 +1,40 @@
+#! /usr/bin/env bash
+
+# This file is part of the HiPACE++ test suite.
+# It runs a Hipace simulation in the blowout regime with and without the tiled beam current
+# deposition, and checks that the results agree. The tile size is smaller than the box, so that
+# several tiles of each color are deposited concurrently with OpenMP.
+
+# abort on first encounted error
+set -eu -o pipefail
+
+# Read input parameters
+HIPACE_EXECUTABLE=$1
+HIPACE_SOURCE_DIR=$2
+
+HIPACE_EXAMPLE_DIR=${HIPACE_SOURCE_DIR}/examples/blowout_wake
+HIPACE_TEST_DIR=${HIPACE_SOURCE_DIR}/tests
+
+FILE_NAME=`basename "$0"`
+TEST_NAME="${FILE_NAME%.*}"
+
+rm -rf ${TEST_NAME}_off
+rm -rf ${TEST_NAME}_on
+# Run the simulation
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        beams.tiled_deposition = 0 \
+        hipace.file_prefix = ${TEST_NAME}_off \
+        max_step = 1
+
+mpiexec -n 1 $HIPACE_EXECUTABLE $HIPACE_EXAMPLE_DIR/inputs_normalized \
+        plasmas.sort_bin_size = 8 \
+        beams.tiled_deposition = 1 \
+        beams.sort_bin_size = 8 \
+        hipace.file_prefix = ${TEST_NAME}_on \
+        max_step = 1
+
+# assert whether the two simulations match
+$HIPACE_EXAMPLE_DIR/analysis_tiled_beam_deposition.py \
+    --off ${TEST_NAME}_off \
+    --on ${TEST_NAME}_on